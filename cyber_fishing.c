@@ -1,50 +1,18 @@
 #include <furi.h>
+#include <furi_hal.h>
 #include <gui/gui.h>
 #include <input/input.h>
 #include <notification/notification_messages.h>
-#include <storage/storage.h>
 #include <stdlib.h>
 
-#define SAVE_PATH EXT_PATH("apps_data/cyber_fishing.save")
-
-typedef enum { 
-    StateSplash, StateWaiting, StateFishing, StateBite, StateCaught, 
-    StateLost, StateShop, StateSell, StateIndex, 
-    StateWorldShop, StatePrestige, StateDevMenu 
-} FishingState;
-
-typedef struct {
-    FishingState current_state;
-    int splash_timer;
-    int fish_timer;
-    int reaction_timer;
-    uint32_t credits;
-    uint32_t high_score;
-    uint32_t buffer_lvl;
-    uint32_t antenna_lvl;
-    uint32_t lure_lvl;
-    uint32_t inv[7];
-    bool discovered[7];
-    bool world_unlocked[5];
-    int current_world;
-    uint32_t core_ver;
-    int shop_cursor;
-    int dev_cursor;
-    int index_cursor;
-    int frame_count;
-    int last_catch_idx;
-    int cheat_step;
-    FuriMessageQueue* event_queue;
-} CyberFishApp;
-
-const char* pkt_names[] = {"TCP_PKT", "UDP_STRM", "SQL_QRY", "SSL_KEY", "ROOT_HASH", "VOID_DATA", "SYS_GLITCH"};
-const char* pkt_desc_a[] = {"Standard", "Fast, but", "Database", "Security", "System", "Data from", "FATAL"};
-const char* pkt_desc_b[] = {"Transport", "Unreliable", "Request", "Layer", "Heart", "The Void", "ERROR"};
-const uint32_t pkt_prices[] = {5, 15, 30, 75, 200, 1000, 5000};
-const char* world_names[] = {"Cyber Dock", "Neon Forest", "Data City", "Void Sector", "Int. Kernel"};
-const uint32_t world_costs[] = {0, 200, 600, 1500, 5000};
-const char* prestige_icons[] = {"[X]", "[O]", "[#]", "[@]", "[&]", "[%]", "[*]", "[!]", "[?]", "[S]"};
-const InputKey cheat_seq[] = {InputKeyUp, InputKeyUp, InputKeyDown, InputKeyDown, InputKeyLeft, InputKeyRight};
+#include "cyber_fishing_content.h"
+#include "cyber_fishing_game.h"
+#include "cyber_fishing_history.h"
+#include "cyber_fishing_input.h"
+#include "cyber_fishing_layer.h"
+#include "cyber_fishing_perf.h"
+#include "cyber_fishing_replay.h"
+#include "cyber_fishing_save.h"
 
 const NotificationSequence sequence_bite = {
     &message_vibro_on, &message_note_c6, &message_delay_50, &message_vibro_off, &message_note_e6, &message_delay_50, &message_sound_off, NULL
@@ -62,63 +30,6 @@ const NotificationSequence sequence_boot = {
     &message_note_e5, &message_delay_50, &message_note_g5, &message_delay_50, &message_note_e6, &message_delay_100, &message_sound_off, NULL
 };
 
-void save_game(CyberFishApp* app) {
-    Storage* storage = furi_record_open(RECORD_STORAGE);
-    File* file = storage_file_alloc(storage);
-    storage_common_mkdir(storage, EXT_PATH("apps_data"));
-    if(storage_file_open(file, SAVE_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
-        storage_file_write(file, &app->credits, sizeof(uint32_t));
-        storage_file_write(file, &app->high_score, sizeof(uint32_t));
-        storage_file_write(file, &app->buffer_lvl, sizeof(uint32_t));
-        storage_file_write(file, &app->antenna_lvl, sizeof(uint32_t));
-        storage_file_write(file, &app->lure_lvl, sizeof(uint32_t));
-        storage_file_write(file, &app->current_world, sizeof(int));
-        storage_file_write(file, &app->core_ver, sizeof(uint32_t));
-        storage_file_write(file, app->inv, sizeof(uint32_t) * 7);
-        storage_file_write(file, app->discovered, sizeof(bool) * 7);
-        storage_file_write(file, app->world_unlocked, sizeof(bool) * 5);
-    }
-    storage_file_close(file);
-    storage_file_free(file);
-    furi_record_close(RECORD_STORAGE);
-}
-
-void reset_game(CyberFishApp* app) {
-    app->credits = 0; 
-    app->buffer_lvl = 1; 
-    app->antenna_lvl = 1; 
-    app->lure_lvl = 1; 
-    app->current_world = 0;
-    for(int i=0; i<7; i++) { 
-        app->inv[i] = 0; 
-        app->discovered[i] = false; 
-    }
-    for(int i=0; i<5; i++) app->world_unlocked[i] = (i == 0);
-}
-
-void load_game(CyberFishApp* app) {
-    reset_game(app);
-    app->core_ver = 1;
-    Storage* storage = furi_record_open(RECORD_STORAGE);
-    File* file = storage_file_alloc(storage);
-    if(storage_file_open(file, SAVE_PATH, FSAM_READ, FSOM_OPEN_EXISTING)) {
-        storage_file_read(file, &app->credits, sizeof(uint32_t));
-        storage_file_read(file, &app->high_score, sizeof(uint32_t));
-        storage_file_read(file, &app->buffer_lvl, sizeof(uint32_t));
-        storage_file_read(file, &app->antenna_lvl, sizeof(uint32_t));
-        storage_file_read(file, &app->lure_lvl, sizeof(uint32_t));
-        storage_file_read(file, &app->current_world, sizeof(int));
-        storage_file_read(file, &app->core_ver, sizeof(uint32_t));
-        storage_file_read(file, app->inv, sizeof(uint32_t) * 7);
-        storage_file_read(file, app->discovered, sizeof(bool) * 7);
-        storage_file_read(file, app->world_unlocked, sizeof(bool) * 5);
-    }
-    storage_file_close(file);
-    storage_file_free(file);
-    furi_record_close(RECORD_STORAGE);
-    if(app->core_ver == 0) app->core_ver = 1;
-}
-
 void draw_logo(Canvas* canvas, int f) {
     canvas_draw_line(canvas, 64, 10, 64, 40);
     canvas_draw_line(canvas, 64, 40, 50, 40);
@@ -134,59 +45,183 @@ void draw_logo(Canvas* canvas, int f) {
     canvas_draw_str_aligned(canvas, 64, 55, AlignCenter, AlignBottom, "CYBER_FISH");
 }
 
+/* Prebuilt by the loader, then only touched from the GUI thread inside render_callback() */
+static WorldLayer world_layer = {.world = -1};
+
+/* The whole game state is statically allocated; see the budgets in cyber_fishing_game.h */
+static CyberFishApp app_state;
+
+/* Written by the main loop, read by the perf page */
+static PerfStats perf;
+
+/* Written by the main loop, read by the stats screen */
+static CatchHistory history;
+
+#define CONTENT_PACK_PATH EXT_PATH("apps_data/cyber_fishing.pack")
+
+/* The pack stays open for the app's lifetime; the GUI thread reads it too */
+typedef struct {
+    File* file;
+    FuriMutex* mutex;
+} ContentPackFile;
+
+static bool pack_read(void* ctx, uint32_t offset, void* buf, size_t len) {
+    ContentPackFile* pack = ctx;
+    if(!storage_file_seek(pack->file, offset, true)) return false;
+    return storage_file_read(pack->file, buf, len) == len;
+}
+
+static void pack_lock(void* ctx) {
+    ContentPackFile* pack = ctx;
+    furi_mutex_acquire(pack->mutex, FuriWaitForever);
+}
+
+static void pack_unlock(void* ctx) {
+    ContentPackFile* pack = ctx;
+    furi_mutex_release(pack->mutex);
+}
+
+/* Falls back to the built-in content when there is no usable pack */
+static void content_pack_open(ContentPackFile* pack, Storage* storage) {
+    pack->file = storage_file_alloc(storage);
+    pack->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    ContentSource source = {.read = pack_read, .lock = pack_lock, .unlock = pack_unlock, .ctx = pack};
+    bool opened = storage_file_open(pack->file, CONTENT_PACK_PATH, FSAM_READ, FSOM_OPEN_EXISTING);
+    if(!content_load(opened ? &source : NULL)) storage_file_close(pack->file);
+}
+
+static void content_pack_close(ContentPackFile* pack) {
+    content_load(NULL);
+    storage_file_close(pack->file);
+    storage_file_free(pack->file);
+    furi_mutex_free(pack->mutex);
+}
+
+#define LOADER_DONE_FLAG (1u << 1)
+/*
+ * The deepest path is load_game -> save_read_file -> save_decode, about
+ * 700 B of frames since the save decodes in place, plus the storage API
+ * calls under it. The launch log reports what the loader left free.
+ */
+#define LOADER_STACK_SIZE 1536
+
+/* Startup work done behind the splash; the main loop reads nothing here until the join */
+typedef struct {
+    CyberFishApp* app;
+    ContentPackFile* pack;
+    FuriThreadId owner;
+    uint32_t stack_free;
+} LoadJob;
+
+static int32_t load_worker(void* ctx) {
+    LoadJob* job = ctx;
+    CyberFishApp* app = job->app;
+    uint32_t t0 = perf_begin();
+    content_pack_open(job->pack, furi_record_open(RECORD_STORAGE));
+    load_game(app);
+    history_init(&history);
+    /* Build the tables the first cast and the first fishing frame need */
+    game_sync_rarity(app);
+    world_layer_prepare(&world_layer, game_world(app)->scene);
+    perf_end(&perf, PerfProbeLoad, t0);
+    /* Read here: the thread's stack is gone once it is joined */
+    job->stack_free = furi_thread_get_stack_space(furi_thread_get_current_id());
+    furi_thread_flags_set(job->owner, LOADER_DONE_FLAG);
+    return 0;
+}
+
 void draw_world_bg(Canvas* canvas, CyberFishApp* app) {
-    int f = app->frame_count;
-    if(app->current_world == 0) {
-        canvas_draw_line(canvas, 0, 45, 55, 45);
-        canvas_draw_line(canvas, 10, 45, 10, 60);
-        canvas_draw_line(canvas, 40, 45, 40, 60);
+    uint32_t t0 = perf_begin();
+    /* Motion is a function of the game clock, so faster redraws only add in-between positions */
+    uint32_t t = app->ui.now_ms;
+    int f = t / GAME_TICK_MS;
+    int scene = game_world(app)->scene;
+    world_layer_prepare(&world_layer, scene);
+    canvas_draw_xbm(canvas, world_layer.x, world_layer.y, world_layer.w, world_layer.h, world_layer.bits);
+    if(scene == 0) {
         for(int i=0; i<4; i++) {
-            int x = (f * 2 + (i * 30)) % 128;
+            int x = (t / (GAME_TICK_MS / 2) + (i * 30)) % 128;
             canvas_draw_dot(canvas, x, 52 + (i%3));
         }
-    } else if(app->current_world == 1) {
-        for(int i=0; i<60; i+=15) {
-            canvas_draw_line(canvas, i, 45, i+5, 20);
-            canvas_draw_line(canvas, i+5, 20, i+10, 45);
-        }
+    } else if(scene == 1) {
         for(int i=0; i<10; i++) {
             int rx = (i * 21) % 128;
             int ry = (f + (i * 7)) % 45;
             canvas_draw_dot(canvas, rx, ry);
         }
-        canvas_draw_line(canvas, 0, 45, 55, 45);
-    } else if(app->current_world == 2) {
+    } else if(scene == 2) {
         for(int i=0; i<128; i+=16) {
             int x_off = (f % 16);
             canvas_draw_line(canvas, i - x_off, 45, (i - x_off) - 10, 64);
         }
-        canvas_draw_frame(canvas, 5, 20, 10, 25);
-        canvas_draw_frame(canvas, 25, 10, 15, 35);
-        canvas_draw_line(canvas, 0, 45, 55, 45);
-    } else if(app->current_world == 3) {
+    } else if(scene == 3) {
         int pulse = (f % 20) / 2;
         canvas_draw_circle(canvas, 100, 20, pulse);
-        for(int i=0; i<15; i++) {
-            canvas_draw_dot(canvas, (i*17)%128, (i*9)%45);
-        }
-        canvas_draw_line(canvas, 0, 45, 55, 45);
-    } else if(app->current_world == 4) {
+    } else if(scene == 4) {
         int shake = (f % 2 == 0) ? 1 : -1;
         for(int i=0; i<40; i+=8) {
             canvas_draw_str(canvas, (i*3)%60 + shake, (i + f)%45, (i%2==0)?"0":"1");
         }
-        canvas_draw_line(canvas, 0, 45, 55, 45);
     }
+    /* Static like world_layer: ENTITY_MAX sprites would sit on the GUI thread's stack */
+    static EntitySprite fish[ENTITY_MAX];
+    uint16_t count = entity_pool_visible(&app->fish, t, fish);
+    for(int i=0; i<count; i++) {
+        canvas_draw_xbm(canvas, fish[i].x, fish[i].y, ENTITY_SPRITE_W, ENTITY_SPRITE_H, fish[i].bits);
+    }
+    perf_end(&perf, PerfProbeWorldBg, t0);
 }
 
-void render_callback(Canvas* canvas, void* ctx) {
-    CyberFishApp* app = ctx;
-    if(app->current_state == StateSplash) {
+static void draw_perf(Canvas* canvas, char* buf, size_t size) {
+    static const char* names[PerfProbeCount] = {"rndr", "bg", "save", "load"};
+    canvas_set_font(canvas, FontSecondary);
+    snprintf(buf, size, "PERF CSV:%s up %lums", perf.csv ? "on" : "off", perf.launch_ms);
+    canvas_draw_str(canvas, 2, 8, buf);
+    for(int i=0; i<PerfProbeCount; i++) {
+        const PerfTiming* t = &perf.probes[i];
+        snprintf(buf, size, "%-4s %5luus mx %lu", names[i], i == PerfProbeRender || i == PerfProbeWorldBg ? t->avg_us : t->last_us, t->max_us);
+        canvas_draw_str(canvas, 2, 16 + (i*8), buf);
+    }
+    snprintf(buf, size, "jit %+ldms mx %lu drop %lu", perf.jitter_ms, perf.jitter_max_ms, perf.dropped_frames);
+    canvas_draw_str(canvas, 2, 48, buf);
+    snprintf(buf, size, "q %lu hw %lu wk %lu rd %lu", perf.queue_depth, perf.queue_high_water, perf.wakeups, perf.redraws);
+    canvas_draw_str(canvas, 2, 56, buf);
+    snprintf(buf, size, "in %lums mx %lu lost %lu", perf.input_lag_ms, perf.input_lag_max_ms, perf.input_dropped);
+    canvas_draw_str(canvas, 2, 64, buf);
+}
+
+/* Everything shown comes from running counters; the log is never read here */
+static void draw_stats(Canvas* canvas, CyberFishApp* app, char* buf, size_t size) {
+    const HistoryStats* st = &history.stats;
+    canvas_set_font(canvas, FontPrimary);
+    canvas_draw_str(canvas, 5, 12, "STATS");
+    canvas_set_font(canvas, FontSecondary);
+    snprintf(buf, size, "%lu catches", st->total);
+    canvas_draw_str(canvas, 50, 12, buf);
+    snprintf(buf, size, "React %lums p95 %lums", history_reaction_mean(st), history_reaction_p95(st));
+    canvas_draw_str(canvas, 5, 24, buf);
+    snprintf(buf, size, "Cr/min %lu  Ach %u/%u", history_credits_per_min(st),
+        achievements_unlocked_count(&app->progress.achievements), achievement_rule_count);
+    canvas_draw_str(canvas, 5, 33, buf);
+    for(int i=0; i<STATS_ROWS; i++) {
+        int w = app->ui.shop_cursor + i;
+        if(w >= content_world_count()) break;
+        uint32_t bites = st->bites[w];
+        snprintf(buf, size, "%s", content_world(w)->name);
+        canvas_draw_str(canvas, 5, 44 + (i*9), buf);
+        snprintf(buf, size, "%lu %lu%%", st->catches[w], bites ? st->catches[w] * 100 / bites : 0);
+        canvas_draw_str(canvas, 75, 44 + (i*9), buf);
+    }
+}
+
+static void render_frame(Canvas* canvas, CyberFishApp* app) {
+    if(app->ui.current_state == StateSplash) {
         canvas_clear(canvas);
-        draw_logo(canvas, app->frame_count);
+        draw_logo(canvas, app->ui.now_ms / GAME_TICK_MS);
         return;
     }
-    bool invert = (app->current_world == 4 && app->current_state == StateBite && (app->frame_count % 4 < 2));
+    uint32_t f = app->ui.now_ms / GAME_TICK_MS;
+    bool invert = (game_world(app)->scene == 4 && app->ui.current_state == StateBite && (f % 4 < 2));
     if(invert) {
         canvas_set_color(canvas, ColorBlack);
         canvas_draw_box(canvas, 0, 0, 128, 64);
@@ -194,266 +229,342 @@ void render_callback(Canvas* canvas, void* ctx) {
     } else {
         canvas_clear(canvas);
     }
-    char buf[64];
-    if(app->current_state == StateDevMenu) {
+    char buf[40];
+    if(app->ui.current_state == StatePerf) {
+        draw_perf(canvas, buf, sizeof(buf));
+    } else if(app->ui.current_state == StateDevMenu) {
+        if(app->ui.dev_status[0]) {
+            canvas_set_font(canvas, FontSecondary);
+            canvas_draw_str(canvas, 2, 10, app->ui.dev_status);
+        } else {
+            canvas_set_font(canvas, FontPrimary);
+            canvas_draw_str(canvas, 2, 12, "ADMIN_TERMINAL.sh");
+        }
+        canvas_set_font(canvas, FontSecondary);
+        const char* options[DEV_MENU_ITEMS] = {"Add 1000 Credits", "Unlock All Worlds", "Max Everything", "Wipe All Progress",
+            app->ui.recording ? "Stop Recording" : "Record Session", "Replay Session", "Perf Monitor"};
+        for(int i=0; i<DEV_MENU_ITEMS; i++) canvas_draw_str(canvas, 12, 20 + (i*7), options[i]);
+        canvas_draw_str(canvas, 2, 20 + (app->ui.dev_cursor * 7), ">");
+    } else if(app->ui.current_state == StateSettings) {
         canvas_set_font(canvas, FontPrimary);
-        canvas_draw_str(canvas, 2, 12, "ADMIN_TERMINAL.sh");
+        canvas_draw_str(canvas, 5, 12, "SETTINGS");
         canvas_set_font(canvas, FontSecondary);
-        const char* options[] = {"Add 1000 Credits", "Unlock All Worlds", "Max Everything", "Wipe All Progress"};
-        for(int i=0; i<4; i++) canvas_draw_str(canvas, 12, 25 + (i*9), options[i]);
-        canvas_draw_str(canvas, 2, 25 + (app->dev_cursor * 9), ">");
-    } else if(app->current_state == StateIndex) {
+        snprintf(buf, sizeof(buf), "Smooth FX: %s", (app->progress.settings & SettingSmoothFx) ? "30fps" : "off");
+        canvas_draw_str(canvas, 10, 25, buf);
+        snprintf(buf, sizeof(buf), "Auto-trawler: %s", (app->progress.settings & SettingAutoTrawler) ? "on" : "off");
+        canvas_draw_str(canvas, 10, 33, buf);
+        snprintf(buf, sizeof(buf), "Min splash: %lums", game_splash_ms(app));
+        canvas_draw_str(canvas, 10, 41, buf);
+        canvas_draw_str(canvas, 10, 49, "Catch Stats");
+        canvas_draw_str(canvas, 2, 25 + (app->ui.shop_cursor * 8), ">");
+    } else if(app->ui.current_state == StateStats) {
+        draw_stats(canvas, app, buf, sizeof(buf));
+    } else if(app->ui.current_state == StateIndex) {
         canvas_set_font(canvas, FontPrimary);
         canvas_draw_str(canvas, 5, 12, "NET_INDEX");
         canvas_set_font(canvas, FontSecondary);
-        for(int i=0; i<7; i++) {
-            snprintf(buf, sizeof(buf), "%s", app->discovered[i] ? pkt_names[i] : "???");
-            canvas_draw_str(canvas, 12, 22 + (i*6), buf);
+        /* Only the visible page is fetched from the registry */
+        uint16_t count = content_packet_count();
+        uint16_t page = app->ui.index_cursor / INDEX_PAGE;
+        snprintf(buf, sizeof(buf), "%u/%u %u%%", page + 1, (count + INDEX_PAGE - 1) / INDEX_PAGE, app->ui.discovered_count * 100u / count);
+        canvas_draw_str(canvas, 70, 12, buf);
+        ContentPacket pkt;
+        for(int i=0; i<INDEX_PAGE; i++) {
+            uint16_t idx = page * INDEX_PAGE + i;
+            if(idx >= count) break;
+            if(game_discovered(app, idx)) content_packet(idx, &pkt);
+            canvas_draw_str(canvas, 12, 22 + (i*6), game_discovered(app, idx) ? pkt.name : "???");
         }
-        canvas_draw_line(canvas, 65, 15, 65, 50); 
-        if(app->discovered[app->index_cursor]) {
-            canvas_draw_str(canvas, 70, 30, pkt_desc_a[app->index_cursor]);
-            canvas_draw_str(canvas, 70, 40, pkt_desc_b[app->index_cursor]);
+        canvas_draw_str(canvas, 5, 22 + ((app->ui.index_cursor % INDEX_PAGE) * 6), ">");
+        canvas_draw_line(canvas, 65, 15, 65, 50);
+        if(game_discovered(app, app->ui.index_cursor)) {
+            content_packet(app->ui.index_cursor, &pkt);
+            canvas_draw_str(canvas, 70, 30, pkt.desc_a);
+            canvas_draw_str(canvas, 70, 40, pkt.desc_b);
         } else {
             canvas_draw_str(canvas, 70, 35, "LOCKED");
         }
         canvas_draw_line(canvas, 5, 52, 120, 52);
         canvas_draw_str(canvas, 5, 62, "CORES:");
-        for(uint32_t i=0; i < (app->core_ver-1) && i < 10; i++) {
+        for(uint32_t i=0; i < (uint32_t)(app->progress.core_ver-1) && i < 10; i++) {
             canvas_draw_str(canvas, 40 + (i*8), 62, prestige_icons[i]);
         }
-    } else if(app->current_state == StatePrestige) {
+    } else if(app->ui.current_state == StatePrestige) {
         canvas_set_font(canvas, FontPrimary);
         canvas_draw_str(canvas, 5, 12, "SYSTEM REFORMAT");
         canvas_set_font(canvas, FontSecondary);
-        bool all_found = true;
-        for(int i=0; i<7; i++) if(!app->discovered[i]) all_found = false;
-        if(!all_found) {
+        if(!game_index_complete(app)) {
             canvas_draw_str(canvas, 10, 30, "Index Incomplete...");
             canvas_draw_str(canvas, 10, 40, "Scan all packets first.");
         } else {
-            snprintf(buf, sizeof(buf), "Current: v%lu", app->core_ver);
+            snprintf(buf, sizeof(buf), "Current: v%u", app->progress.core_ver);
             canvas_draw_str(canvas, 10, 25, buf);
             canvas_draw_str(canvas, 10, 35, "REFORMAT? [OK]");
-            canvas_draw_str(canvas, 10, 45, "(Reset for 25% Bonus)");
+            snprintf(buf, sizeof(buf), "(Reset for %u%% Bonus)", PRESTIGE_BONUS_PCT);
+            canvas_draw_str(canvas, 10, 45, buf);
         }
-    } else if(app->current_state == StateShop || app->current_state == StateWorldShop || app->current_state == StateSell) {
+    } else if(app->ui.current_state == StateShop || app->ui.current_state == StateWorldShop || app->ui.current_state == StateSell) {
         canvas_set_font(canvas, FontPrimary);
-        if(app->current_state == StateShop) canvas_draw_str(canvas, 5, 12, "HARDWARE");
-        else if(app->current_state == StateWorldShop) canvas_draw_str(canvas, 5, 12, "TRAVEL");
+        if(app->ui.current_state == StateShop) canvas_draw_str(canvas, 5, 12, "HARDWARE");
+        else if(app->ui.current_state == StateWorldShop) canvas_draw_str(canvas, 5, 12, "TRAVEL");
         else canvas_draw_str(canvas, 5, 12, "MARKET");
         canvas_set_font(canvas, FontSecondary);
-        snprintf(buf, sizeof(buf), "Cr: %lu", app->credits);
+        snprintf(buf, sizeof(buf), "Cr: %lu", app->progress.credits);
         canvas_draw_str(canvas, 80, 12, buf);
-        if(app->current_state == StateShop) {
-            snprintf(buf, sizeof(buf), "Buff L%lu (50c)", app->buffer_lvl);
+        if(app->ui.current_state == StateShop) {
+            snprintf(buf, sizeof(buf), "Buff L%u (%uc)", app->progress.buffer_lvl, SHOP_BUFFER_COST);
             canvas_draw_str(canvas, 10, 25, buf);
-            snprintf(buf, sizeof(buf), "Ant  L%lu (80c)", app->antenna_lvl);
+            snprintf(buf, sizeof(buf), "Ant  L%u (%uc)", app->progress.antenna_lvl, SHOP_ANTENNA_COST);
             canvas_draw_str(canvas, 10, 33, buf);
-            snprintf(buf, sizeof(buf), "Lure L%lu (60c)", app->lure_lvl);
+            snprintf(buf, sizeof(buf), "Lure L%u (%uc)", app->progress.lure_lvl, SHOP_LURE_COST);
             canvas_draw_str(canvas, 10, 41, buf);
-            canvas_draw_str(canvas, 2, 25 + (app->shop_cursor * 8), ">");
-        } else if(app->current_state == StateWorldShop) {
-            for(int i=0; i<5; i++) {
-                snprintf(buf, sizeof(buf), "%s %s", world_names[i], app->world_unlocked[i] ? "[OK]" : "[LOK]");
-                canvas_draw_str(canvas, 10, 25 + (i*7), buf);
+            canvas_draw_str(canvas, 2, 25 + (app->ui.shop_cursor * 8), ">");
+        } else if(app->ui.current_state == StateWorldShop) {
+            /* Five rows, scrolled so the cursor stays visible */
+            int first = app->ui.shop_cursor < 5 ? 0 : app->ui.shop_cursor - 4;
+            for(int i=first; i<content_world_count() && i<first+5; i++) {
+                const ContentWorld* world = content_world(i);
+                if(game_world_unlocked(app, i)) snprintf(buf, sizeof(buf), "%s [OK]", world->name);
+                else snprintf(buf, sizeof(buf), "%s %luc", world->name, world->cost);
+                canvas_draw_str(canvas, 10, 25 + ((i - first)*7), buf);
             }
-            canvas_draw_str(canvas, 2, 25 + (app->shop_cursor * 7), ">");
+            canvas_draw_str(canvas, 2, 25 + ((app->ui.shop_cursor - first) * 7), ">");
+        } else if(app->progress.inv_used == 0) {
+            canvas_draw_str(canvas, 10, 35, "No packets to sell");
         } else {
-            snprintf(buf, sizeof(buf), "Sell %s: %luc", pkt_names[app->shop_cursor], (uint32_t)(pkt_prices[app->shop_cursor] * (1.0 + (app->core_ver-1)*0.25)));
+            const InvStack* stack = &app->progress.inv[app->ui.shop_cursor];
+            ContentPacket pkt;
+            content_packet(stack->pkt, &pkt);
+            snprintf(buf, sizeof(buf), "Sell %s: %luc", pkt.name, game_price(stack->pkt, app->progress.core_ver));
             canvas_draw_str(canvas, 10, 30, buf);
-            snprintf(buf, sizeof(buf), "Stock: %lu", app->inv[app->shop_cursor]);
+            snprintf(buf, sizeof(buf), "Stock: %lu  [%u/%u]", stack->count, app->ui.shop_cursor + 1, app->progress.inv_used);
             canvas_draw_str(canvas, 10, 40, buf);
             canvas_draw_str(canvas, 2, 30, ">");
+            canvas_draw_str(canvas, 10, 52, "Hold OK: sell stack");
+            canvas_draw_str(canvas, 10, 61, "Hold RT: sell all");
         }
     } else {
         draw_world_bg(canvas, app);
-        canvas_draw_circle(canvas, 45, 35, 3);
-        canvas_draw_line(canvas, 45, 38, 45, 43);
-        int rod_y = (app->current_state == StateBite && (app->frame_count % 2)) ? 22 : 25;
+        int rod_y = (app->ui.current_state == StateBite && (f % 2)) ? 22 : 25;
         canvas_draw_line(canvas, 45, 38, 70, rod_y);
         canvas_draw_line(canvas, 70, rod_y, 70, 50);
         canvas_set_font(canvas, FontSecondary);
-        snprintf(buf, sizeof(buf), "v%lu | C:%lu | %s", app->core_ver, app->credits, world_names[app->current_world]);
+        snprintf(buf, sizeof(buf), "v%u | C:%lu | %s", app->progress.core_ver, app->progress.credits, game_world(app)->name);
         canvas_draw_str(canvas, 2, 10, buf);
-        if(app->current_state == StateWaiting) {
+        if(app->ui.current_state == StateWaiting) {
             canvas_draw_str(canvas, 60, 22, "UP:Shop DN:Sell");
             canvas_draw_str(canvas, 60, 32, "LT:Index OK:Go");
-        } else if(app->current_state == StateCaught) {
-            snprintf(buf, sizeof(buf), "+ %s", pkt_names[app->last_catch_idx]);
+            canvas_draw_str(canvas, 60, 42, "RT:Settings");
+            if(app->ui.trawled) {
+                snprintf(buf, sizeof(buf), "Trawled +%lu", app->ui.trawled);
+                canvas_draw_str(canvas, 60, 52, buf);
+            }
+        } else if(app->ui.current_state == StateCaught) {
+            ContentPacket pkt;
+            content_packet(app->ui.last_catch_idx, &pkt);
+            snprintf(buf, sizeof(buf), "+ %s", pkt.name);
             canvas_draw_str(canvas, 60, 30, buf);
-        } else if(app->current_state == StateLost) {
+            if(app->ui.last_catch_sold) canvas_draw_str(canvas, 60, 40, "(sold)");
+        } else if(app->ui.current_state == StateLost) {
             canvas_set_font(canvas, FontPrimary);
             canvas_draw_str(canvas, 60, 30, "LOST PKT!");
-        } else if(app->current_state == StateBite) {
+        } else if(app->ui.current_state == StateBite) {
             canvas_set_font(canvas, FontPrimary);
             canvas_draw_str(canvas, 75, 30, "BITE!");
         }
     }
 }
 
+void render_callback(Canvas* canvas, void* ctx) {
+    uint32_t t0 = perf_begin();
+    render_frame(canvas, ctx);
+    perf_end(&perf, PerfProbeRender, t0);
+}
+
 void input_callback(InputEvent* input_event, void* ctx) {
-    FuriMessageQueue* event_queue = ctx;
-    furi_message_queue_put(event_queue, input_event, FuriWaitForever);
+    input_ring_push(ctx, input_event);
+}
+
+static bool game_input_from_event(const StampedInput* event, GameInput* input) {
+    input->time = event->time;
+    if(event->type == InputTypeShort) input->type = GameInputShort;
+    else if(event->type == InputTypeLong) input->type = GameInputLong;
+    else return false;
+    switch(event->key) {
+    case InputKeyUp: input->key = GameKeyUp; break;
+    case InputKeyDown: input->key = GameKeyDown; break;
+    case InputKeyRight: input->key = GameKeyRight; break;
+    case InputKeyLeft: input->key = GameKeyLeft; break;
+    case InputKeyOk: input->key = GameKeyOk; break;
+    case InputKeyBack: input->key = GameKeyBack; break;
+    default: return false;
+    }
+    return true;
 }
 
 int32_t cyber_fishing_app(void* p) {
     UNUSED(p);
-    CyberFishApp* app = malloc(sizeof(CyberFishApp));
-    app->current_state = StateSplash;
-    app->splash_timer = 20; 
-    app->cheat_step = 0;
-    app->event_queue = furi_message_queue_alloc(8, sizeof(InputEvent));
-    load_game(app);
+    uint32_t launch = furi_get_tick();
+    CyberFishApp* app = &app_state;
+    game_init(app);
+    static InputRing input_ring;
+    input_ring_init(&input_ring);
+    SaveEngine save;
+    save_engine_init(&save);
+    ReplayRecorder recorder;
+    replay_recorder_init(&recorder);
+    ContentPackFile pack;
+    /* Seeded first: the auto-trawler draws from the game PRNG while loading */
+    game_seed(app, furi_hal_random_get());
+    game_events_init();
+    LoadJob job = {.app = app, .pack = &pack, .owner = furi_thread_get_current_id()};
+    FuriThread* loader = furi_thread_alloc_ex("CyberFishLoad", LOADER_STACK_SIZE, load_worker, &job);
+    furi_thread_start(loader);
+    /* app_state starts zeroed, which is StateSplash; only now_ms is touched until the join */
+    app->ui.now_ms = launch;
     ViewPort* view_port = view_port_alloc();
     view_port_draw_callback_set(view_port, render_callback, app);
-    view_port_input_callback_set(view_port, input_callback, app->event_queue);
+    view_port_input_callback_set(view_port, input_callback, &input_ring);
     Gui* gui = furi_record_open(RECORD_GUI);
     gui_add_view_port(gui, view_port, GuiLayerFullscreen);
     NotificationApp* notifications = furi_record_open(RECORD_NOTIFICATION);
     notification_message(notifications, &sequence_boot);
-    InputEvent event;
-    int vib_rarity = 0;
+    /* The logo animates until the loader is done; presses wait in the input ring */
+    while(furi_thread_flags_wait(LOADER_DONE_FLAG, FuriFlagWaitAny, GAME_TICK_MS) & FuriFlagError) {
+        app->ui.now_ms = furi_get_tick();
+        view_port_update(view_port);
+    }
+    furi_thread_join(loader);
+    furi_thread_free(loader);
+    FURI_LOG_I("CyberFish", "loader stack: %lu of %d bytes never used", job.stack_free, LOADER_STACK_SIZE);
+    /* The minimum splash time counts from launch, so a slow load does not add to it */
+    game_start(app, launch);
+    /* Unlocks as of the previous step, so only new ones get announced */
+    AchievementState ach_seen = app->progress.achievements;
+    /* Restamp saved_at now, so the next launch only credits time spent closed */
+    if(app->progress.settings & SettingAutoTrawler) save_mark_dirty(&save, furi_get_tick());
+    StampedInput event;
+    GameInput input;
+    uint32_t last_wake = furi_get_tick();
     bool running = true;
     while(running) {
-        FuriStatus status = furi_message_queue_get(app->event_queue, &event, 100);
-        if(status == FuriStatusOk) {
-            if(app->current_state == StateWaiting && (event.type == InputTypeShort || event.type == InputTypeLong)) {
-                if(event.key == cheat_seq[app->cheat_step]) {
-                    app->cheat_step++;
-                    if(app->cheat_step == 6) {
-                        app->current_state = StateDevMenu;
-                        app->dev_cursor = 0;
-                        app->cheat_step = 0;
-                        notification_message(notifications, &sequence_success);
-                    }
-                } else if(event.key != InputKeyOk) {
-                    app->cheat_step = 0;
-                }
-            }
-            if(event.type == InputTypeShort) {
-                if(event.key == InputKeyBack) {
-                    if(app->current_state == StateWaiting || app->current_state == StateSplash) {
-                        running = false;
-                    } else {
-                        app->current_state = StateWaiting;
-                    }
-                } else if(app->current_state == StateDevMenu) {
-                    if(event.key == InputKeyDown) app->dev_cursor = (app->dev_cursor + 1) % 4;
-                    else if(event.key == InputKeyUp) app->dev_cursor = (app->dev_cursor - 1 + 4) % 4;
-                    else if(event.key == InputKeyOk) {
-                        if(app->dev_cursor == 0) app->credits += 1000;
-                        else if(app->dev_cursor == 1) { for(int i=0; i<5; i++) app->world_unlocked[i] = true; }
-                        else if(app->dev_cursor == 2) {
-                            app->credits = 50000; app->buffer_lvl = 8; app->antenna_lvl = 8; app->lure_lvl = 8;
-                            for(int i=0; i<5; i++) app->world_unlocked[i] = true;
-                            for(int i=0; i<7; i++) app->discovered[i] = true;
-                        } else if(app->dev_cursor == 3) {
-                            app->core_ver = 1; reset_game(app);
-                        }
-                        furi_delay_ms(100);
-                        save_game(app);
-                        notification_message(notifications, &sequence_blink_green_100);
-                    }
-                } else if(app->current_state == StateIndex) {
-                    if(event.key == InputKeyDown) app->index_cursor = (app->index_cursor + 1) % 7;
-                    else if(event.key == InputKeyUp) app->index_cursor = (app->index_cursor - 1 + 7) % 7;
-                } else if(app->current_state == StatePrestige) {
-                    bool all_found = true;
-                    for(int i=0; i<7; i++) if(!app->discovered[i]) all_found = false;
-                    if(all_found && event.key == InputKeyOk) {
-                        app->core_ver++;
-                        reset_game(app);
-                        save_game(app);
-                        app->current_state = StateWaiting;
-                        notification_message(notifications, &sequence_success);
-                    }
-                } else if(app->current_state == StateShop) {
-                    if(event.key == InputKeyRight) {
-                        app->current_state = StateWorldShop;
-                        app->shop_cursor = 0;
-                    } else if(event.key == InputKeyLeft) {
-                        app->current_state = StatePrestige;
-                    } else if(event.key == InputKeyDown) app->shop_cursor = (app->shop_cursor + 1) % 3;
-                    else if(event.key == InputKeyUp) app->shop_cursor = (app->shop_cursor - 1 + 3) % 3;
-                    else if(event.key == InputKeyOk) {
-                        if(app->shop_cursor == 0 && app->credits >= 50) { app->credits -= 50; app->buffer_lvl++; }
-                        else if(app->shop_cursor == 1 && app->credits >= 80) { app->credits -= 80; app->antenna_lvl++; }
-                        else if(app->shop_cursor == 2 && app->credits >= 60) { app->credits -= 60; app->lure_lvl++; }
-                        save_game(app);
-                    }
-                } else if(app->current_state == StateWorldShop) {
-                    if(event.key == InputKeyLeft) {
-                        app->current_state = StateShop;
-                        app->shop_cursor = 0;
-                    } else if(event.key == InputKeyDown) app->shop_cursor = (app->shop_cursor + 1) % 5;
-                    else if(event.key == InputKeyUp) app->shop_cursor = (app->shop_cursor - 1 + 5) % 5;
-                    else if(event.key == InputKeyOk) {
-                        if(!app->world_unlocked[app->shop_cursor] && app->credits >= world_costs[app->shop_cursor]) {
-                            app->credits -= world_costs[app->shop_cursor];
-                            app->world_unlocked[app->shop_cursor] = true;
-                        } else if(app->world_unlocked[app->shop_cursor]) {
-                            app->current_world = app->shop_cursor;
-                            app->current_state = StateWaiting;
-                        }
-                        save_game(app);
-                    }
-                } else if(app->current_state == StateSell) {
-                    if(event.key == InputKeyDown) app->shop_cursor = (app->shop_cursor + 1) % 7;
-                    else if(event.key == InputKeyUp) app->shop_cursor = (app->shop_cursor - 1 + 7) % 7;
-                    else if(event.key == InputKeyOk && app->inv[app->shop_cursor] > 0) {
-                        app->inv[app->shop_cursor]--;
-                        app->credits += (uint32_t)(pkt_prices[app->shop_cursor] * (1.0 + (app->core_ver-1)*0.25));
-                        save_game(app);
-                    }
-                } else if(app->current_state == StateWaiting) {
-                    if(event.key == InputKeyUp) { app->current_state = StateShop; app->shop_cursor = 0; }
-                    else if(event.key == InputKeyDown) { app->current_state = StateSell; app->shop_cursor = 0; }
-                    else if(event.key == InputKeyLeft) { app->current_state = StateIndex; app->index_cursor = 0; }
-                    else if(event.key == InputKeyOk) {
-                        app->current_state = StateFishing;
-                        app->fish_timer = (rand() % 40) + 10 - (app->lure_lvl * 2) - (app->current_world * 3);
-                    }
-                } else if(app->current_state == StateBite && event.key == InputKeyOk) {
-                    app->inv[vib_rarity]++;
-                    app->discovered[vib_rarity] = true;
-                    app->last_catch_idx = vib_rarity;
-                    app->current_state = StateCaught;
-                    notification_message(notifications, &sequence_catch);
-                    save_game(app);
-                } else if((app->current_state == StateCaught || app->current_state == StateLost) && event.key == InputKeyOk) {
-                    app->current_state = StateWaiting;
-                }
-            }
+        /* Static screens block on input; only a pending save or CSV row can wake them */
+        uint32_t frame_ms = game_frame_interval(app);
+        uint32_t timeout = frame_ms ? frame_ms : FuriWaitForever;
+        /* Wake exactly when a bite lands or a window closes, not on the next frame */
+        uint32_t timer_wait = game_timeout(app, furi_get_tick());
+        if(timer_wait < timeout) timeout = timer_wait;
+        uint32_t flushes = save.flushes;
+        uint32_t t0 = perf_begin();
+        uint32_t save_wait = save_poll(&save, app, furi_get_tick());
+        if(save.flushes != flushes) perf_end(&perf, PerfProbeSave, t0);
+        if(save_wait < timeout) timeout = save_wait;
+        /* Rows are written from this loop, so a static screen must not starve the CSV */
+        uint32_t csv_wait = perf_csv_wait(&perf, furi_get_tick());
+        if(csv_wait < timeout) timeout = csv_wait;
+        perf.queue_depth = input_ring_count(&input_ring);
+        if(perf.queue_depth > perf.queue_high_water) perf.queue_high_water = perf.queue_depth;
+        uint32_t wait_start = furi_get_tick();
+        bool woken = input_ring_wait(&input_ring, timeout);
+        uint32_t now = furi_get_tick();
+        perf_loop_wait(&perf, timeout, now - wait_start, !woken, now - last_wake, frame_ms);
+        last_wake = now;
+        perf.input_dropped = input_ring.dropped;
+        bool popped = woken && input_ring_pop(&input_ring, &event);
+        /* input_ring_wait() returns at once while events are queued, so every
+           captured input is stepped before the next timed step can expire a bite */
+        if(woken && !popped) continue;
+        bool has_input = popped && game_input_from_event(&event, &input);
+        if(has_input) {
+            perf_input_lag(&perf, now - event.time);
+            /* A press counts from when it was captured, but never before a step
+               that already ran, so the recorded times replay to the same state */
+            if((int32_t)(input.time - app->ui.now_ms) < 0) input.time = app->ui.now_ms;
+            replay_record_input(&recorder, &input);
+        } else if(popped) {
+            continue;
         }
-        if(app->current_state == StateSplash) {
-            app->splash_timer--;
-            if(app->splash_timer <= 0) app->current_state = StateWaiting;
-        } else if(app->current_state == StateFishing) {
-            app->fish_timer--;
-            if(app->fish_timer <= 0) {
-                app->current_state = StateBite;
-                notification_message(notifications, &sequence_bite);
-                app->reaction_timer = 20 + (app->buffer_lvl * 5) - (app->current_world * 3);
-                int r = rand() % 100 + (app->antenna_lvl * 4) + (app->current_world * 20);
-                vib_rarity = (r > 180) ? 6 : (r > 150) ? 5 : (r > 120) ? 4 : (r > 90) ? 3 : (r > 70) ? 2 : (r > 40) ? 1 : 0;
+        FishingState prev_state = app->ui.current_state;
+        uint32_t fx = game_step(app, has_input ? &input : NULL, now);
+        if(fx & GameEffectExit) running = false;
+        if(!perf.launched && app->ui.current_state != StateSplash) {
+            perf.launched = true;
+            perf.launch_ms = now - launch;
+            FURI_LOG_I("CyberFish", "interactive after %lums, load %luus", perf.launch_ms, perf.probes[PerfProbeLoad].last_us);
+        }
+        if(fx & GameEffectRecord) {
+            if(recorder.active) {
+                replay_record_stop(&recorder, app);
+                snprintf(app->ui.dev_status, sizeof(app->ui.dev_status), "REC saved: %lu inputs", recorder.events);
+            } else if(replay_record_start(&recorder, app)) {
+                snprintf(app->ui.dev_status, sizeof(app->ui.dev_status), "REC started");
+            } else {
+                snprintf(app->ui.dev_status, sizeof(app->ui.dev_status), "REC failed");
             }
-        } else if(app->current_state == StateBite) {
-            app->reaction_timer--;
-            if(app->reaction_timer <= 0) {
-                app->current_state = StateLost;
-                notification_message(notifications, &sequence_fail);
+            app->ui.recording = recorder.active;
+        }
+        if((fx & GameEffectReplay) && recorder.active) {
+            snprintf(app->ui.dev_status, sizeof(app->ui.dev_status), "Stop recording first");
+        } else if(fx & GameEffectReplay) {
+            ReplayResult result;
+            replay_run(&result);
+            if(!result.loaded) snprintf(app->ui.dev_status, sizeof(app->ui.dev_status), "No valid recording");
+            else snprintf(app->ui.dev_status, sizeof(app->ui.dev_status), "%s %lus %lums", result.match ? "REPLAY OK" : "MISMATCH", result.span_ms / 1000, result.elapsed_ms);
+            notification_message(notifications, result.match ? &sequence_success : &sequence_error);
+        }
+        if(fx & GameEffectPerfCsv) {
+            if(perf.csv) perf_csv_stop(&perf);
+            else perf_csv_start(&perf);
+        }
+        perf_csv_poll(&perf, now);
+        history_poll(&history);
+        if(fx & GameEffectSave) save_mark_dirty(&save, furi_get_tick());
+        /* A prestige both succeeds and unlocks; play the sequence once */
+        if(fx & (GameEffectSuccess | GameEffectAchievement)) notification_message(notifications, &sequence_success);
+        if(fx & GameEffectBlink) notification_message(notifications, &sequence_blink_green_100);
+        if(fx & GameEffectBite) {
+            history_bite(&history, app->progress.current_world);
+            notification_message(notifications, &sequence_bite);
+        }
+        if(fx & GameEffectCatch) {
+            /* Only an OK press catches, so input holds the reel-in time */
+            uint32_t reaction = input.time - app->ui.bite_at;
+            HistoryCatch rec = {
+                .time = furi_hal_rtc_get_timestamp(),
+                .pkt = app->ui.last_catch_idx,
+                .world = app->progress.current_world,
+                .tier = app->ui.bite_tier,
+                .reaction_ms = reaction > UINT16_MAX ? UINT16_MAX : reaction,
+                .price = game_price(app->ui.last_catch_idx, app->progress.core_ver),
+            };
+            history_add(&history, &rec, now);
+            notification_message(notifications, &sequence_catch);
+        }
+        if(fx & GameEffectFail) notification_message(notifications, &sequence_fail);
+        if(fx & GameEffectAchievement) {
+            for(uint16_t i=0; i<achievement_rule_count; i++) {
+                if(!achievement_unlocked(&app->progress.achievements, i) || achievement_unlocked(&ach_seen, i)) continue;
+                FURI_LOG_I("CyberFish", "achievement: %s", achievement_rules[i].name);
             }
         }
-        app->frame_count++;
-        view_port_update(view_port);
+        ach_seen = app->progress.achievements;
+        if(has_input || frame_ms || app->ui.current_state != prev_state) {
+            view_port_update(view_port);
+            perf.redraws++;
+        }
     }
+    replay_record_stop(&recorder, app);
+    perf_csv_stop(&perf);
+    if(app->progress.settings & SettingAutoTrawler) save_mark_dirty(&save, furi_get_tick());
+    save_flush(&save, app);
+    history_close(&history);
+    FURI_LOG_I("CyberFish", "wakeups %lu, redraws %lu, saves %lu", perf.wakeups, perf.redraws, save.flushes);
     notification_message(notifications, &sequence_reset_vibro);
     gui_remove_view_port(gui, view_port);
     view_port_free(view_port);
-    furi_message_queue_free(app->event_queue);
+    content_pack_close(&pack);
+    furi_record_close(RECORD_STORAGE);
     furi_record_close(RECORD_GUI);
     furi_record_close(RECORD_NOTIFICATION);
-    free(app);
     return 0;
 }
@@ -0,0 +1,72 @@
+#include "cyber_fishing_achievements.h"
+
+/* Builtin tiers: 5 is VOID_DATA, 6 is SYS_GLITCH; world 0 is the Cyber Dock */
+const AchievementRule achievement_rules[] = {
+    {"First Contact", GameEventCatch, ACH_ANY, ACH_ANY, AchCounterCaught, 1},
+    {"Packet Sniffer", GameEventCatch, ACH_ANY, ACH_ANY, AchCounterCaught, 100},
+    {"Deep Inspection", GameEventCatch, ACH_ANY, ACH_ANY, AchCounterCaught, 1000},
+    {"Dock Glitch", GameEventCatch, 0, 6, ACH_NO_COUNTER, 0},
+    {"Into the Void", GameEventCatch, ACH_ANY, 5, ACH_NO_COUNTER, 0},
+    {"Fence", GameEventSell, ACH_ANY, ACH_ANY, AchCounterSold, 100},
+    {"Broker", GameEventSell, ACH_ANY, ACH_ANY, AchCounterSold, 1000},
+    {"Data Baron", GameEventSell, ACH_ANY, ACH_ANY, AchCounterEarned, 100000},
+    {"Overclocked", GameEventBuy, ACH_ANY, ACH_ANY, AchCounterBought, 1},
+    {"Long Range", GameEventBuy, ACH_ANY, GameBuyAntenna, ACH_NO_COUNTER, 10},
+    {"Landlord", GameEventBuy, ACH_ANY, GameBuyWorld, ACH_NO_COUNTER, 3},
+    {"Tourist", GameEventTravel, ACH_ANY, ACH_ANY, ACH_NO_COUNTER, 0},
+    {"Kernel Access", GameEventTravel, 4, ACH_ANY, ACH_NO_COUNTER, 0},
+    {"Reformatted", GameEventPrestige, ACH_ANY, ACH_ANY, ACH_NO_COUNTER, 2},
+    {"Legacy Core", GameEventPrestige, ACH_ANY, ACH_ANY, ACH_NO_COUNTER, 5},
+};
+const uint16_t achievement_rule_count = sizeof(achievement_rules) / sizeof(achievement_rules[0]);
+
+_Static_assert(sizeof(achievement_rules) / sizeof(achievement_rules[0]) <= ACH_MAX, "unlock bitset too small");
+
+typedef struct {
+    uint8_t event;
+    bool credits; /* Adds the event's credits instead of its count */
+} AchCounterSpec;
+
+static const AchCounterSpec counter_specs[AchCounters] = {
+    [AchCounterCaught] = {GameEventCatch, false},
+    [AchCounterSold] = {GameEventSell, false},
+    [AchCounterEarned] = {GameEventSell, true},
+    [AchCounterBought] = {GameEventBuy, false},
+};
+
+/* The table the rule handlers index; set once by achievements_subscribe() */
+static const AchievementRule* active_rules;
+
+static bool ach_count(void* target, const GameEvent* event, uint16_t arg) {
+    AchievementState* state = target;
+    uint32_t add = counter_specs[arg].credits ? event->credits : event->count;
+    uint32_t room = UINT32_MAX - state->counters[arg];
+    state->counters[arg] += add < room ? add : room;
+    return false;
+}
+
+static bool ach_rule(void* target, const GameEvent* event, uint16_t id) {
+    AchievementState* state = target;
+    if(achievement_unlocked(state, id)) return false;
+    const AchievementRule* rule = &active_rules[id];
+    if(rule->world != ACH_ANY && rule->world != event->world) return false;
+    if(rule->subject != ACH_ANY && rule->subject != event->subject) return false;
+    uint32_t value = rule->counter == ACH_NO_COUNTER ? event->count : state->counters[rule->counter];
+    if(value < rule->target) return false;
+    state->unlocked[id >> 5] |= 1u << (id & 31);
+    return true;
+}
+
+bool achievements_subscribe(EventBus* bus, const AchievementRule* rules, uint16_t count) {
+    bool ok = count <= ACH_MAX;
+    active_rules = rules;
+    for(int c=0; c<AchCounters; c++) ok = ok && event_subscribe(bus, counter_specs[c].event, ach_count, c);
+    for(uint16_t i=0; i<count && i<ACH_MAX; i++) ok = ok && event_subscribe(bus, rules[i].event, ach_rule, i);
+    return ok;
+}
+
+uint16_t achievements_unlocked_count(const AchievementState* state) {
+    uint16_t count = 0;
+    for(int w=0; w<ACH_WORDS; w++) count += __builtin_popcount(state->unlocked[w]);
+    return count;
+}
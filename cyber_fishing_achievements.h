@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "cyber_fishing_events.h"
+
+/*
+ * Achievements as data. Each rule subscribes to the one event type it is
+ * about and, when an event passes its world and subject filters, compares
+ * either the event's own count or a running counter against its target.
+ * Counters are bumped by their own subscribers, which run before the
+ * rules. Nothing is rescanned: a rule costs time only when its event
+ * fires, and an unlocked rule returns after one bit test.
+ */
+
+#ifndef ACH_WORDS
+#define ACH_WORDS 1
+#endif
+#define ACH_MAX (ACH_WORDS * 32)
+#define ACH_ANY (-1)
+#define ACH_NO_COUNTER 0xFF
+
+typedef enum {
+    AchCounterCaught,
+    AchCounterSold,
+    AchCounterEarned, /* Credits from sales */
+    AchCounterBought,
+    AchCounters,
+} AchCounter;
+
+/* Saved with the progress record; packed because it sits at an odd offset there */
+typedef struct __attribute__((packed)) {
+    uint32_t unlocked[ACH_WORDS];
+    uint32_t counters[AchCounters];
+} AchievementState;
+
+typedef struct {
+    const char* name;
+    uint8_t event; /* GameEventType */
+    int8_t world; /* ACH_ANY or a world index */
+    int8_t subject; /* ACH_ANY, a rarity tier or a GameBuyItem */
+    uint8_t counter; /* AchCounter, or ACH_NO_COUNTER to use the event's count */
+    uint32_t target;
+} AchievementRule;
+
+extern const AchievementRule achievement_rules[];
+extern const uint16_t achievement_rule_count;
+
+/*
+ * Subscribes the counters, then count rules from the table. The table must
+ * outlive the bus; one table is active at a time. False if the bus is full.
+ */
+bool achievements_subscribe(EventBus* bus, const AchievementRule* rules, uint16_t count);
+
+static inline bool achievement_unlocked(const AchievementState* state, uint16_t id) {
+    return state->unlocked[id >> 5] & (1u << (id & 31));
+}
+
+uint16_t achievements_unlocked_count(const AchievementState* state);
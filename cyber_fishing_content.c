@@ -0,0 +1,180 @@
+#include "cyber_fishing_content.h"
+
+#include <string.h>
+
+static const ContentPacket builtin_packets[] = {
+    {"TCP_PKT", "Standard", "Transport", 5},
+    {"UDP_STRM", "Fast, but", "Unreliable", 15},
+    {"SQL_QRY", "Database", "Request", 30},
+    {"SSL_KEY", "Security", "Layer", 75},
+    {"ROOT_HASH", "System", "Heart", 200},
+    {"VOID_DATA", "Data from", "The Void", 1000},
+    {"SYS_GLITCH", "FATAL", "ERROR", 5000},
+};
+
+static const ContentWorld builtin_worlds[] = {
+    {"Cyber Dock", 0, 0, 0, 0},
+    {"Neon Forest", 200, 1, 1, 0},
+    {"Data City", 600, 2, 2, 0},
+    {"Void Sector", 1500, 3, 3, 0},
+    {"Int. Kernel", 5000, 4, 4, 0},
+};
+
+typedef struct {
+    ContentSource source;
+    bool from_pack;
+    uint16_t packet_count;
+    uint8_t world_count;
+    uint32_t packets_offset;
+    uint16_t tier_first[CONTENT_TIERS];
+    uint16_t tier_count[CONTENT_TIERS];
+    ContentWorld worlds[CONTENT_MAX_WORLDS];
+    /* Tiny LRU over packet records; tag 0xFFFF marks an empty slot */
+    uint16_t cache_tag[CONTENT_CACHE_SLOTS];
+    uint8_t cache_age[CONTENT_CACHE_SLOTS];
+    ContentPacket cache[CONTENT_CACHE_SLOTS];
+} ContentRegistry;
+
+static ContentRegistry registry;
+
+static void content_lock(void) {
+    if(registry.source.lock) registry.source.lock(registry.source.ctx);
+}
+
+static void content_unlock(void) {
+    if(registry.source.unlock) registry.source.unlock(registry.source.ctx);
+}
+
+static void content_set_tiers(const uint16_t* tier_start) {
+    for(int t=0; t<CONTENT_TIERS; t++) {
+        registry.tier_first[t] = tier_start[t];
+        registry.tier_count[t] = tier_start[t + 1] - tier_start[t];
+    }
+    /* An empty tier falls back to the closest lower tier, then the closest higher one */
+    for(int t=0; t<CONTENT_TIERS; t++) {
+        if(tier_start[t + 1] != tier_start[t]) continue;
+        for(int d=1; d<CONTENT_TIERS; d++) {
+            int lo = t - d, hi = t + d;
+            if(lo >= 0 && tier_start[lo + 1] != tier_start[lo]) {
+                registry.tier_first[t] = tier_start[lo];
+                registry.tier_count[t] = tier_start[lo + 1] - tier_start[lo];
+                break;
+            }
+            if(hi < CONTENT_TIERS && tier_start[hi + 1] != tier_start[hi]) {
+                registry.tier_first[t] = tier_start[hi];
+                registry.tier_count[t] = tier_start[hi + 1] - tier_start[hi];
+                break;
+            }
+        }
+    }
+}
+
+static void content_use_builtin(void) {
+    static const uint16_t builtin_tiers[CONTENT_TIERS + 1] = {0, 1, 2, 3, 4, 5, 6, 7};
+    memset(&registry.source, 0, sizeof(registry.source));
+    registry.from_pack = false;
+    registry.packet_count = sizeof(builtin_packets) / sizeof(builtin_packets[0]);
+    registry.world_count = sizeof(builtin_worlds) / sizeof(builtin_worlds[0]);
+    memcpy(registry.worlds, builtin_worlds, sizeof(builtin_worlds));
+    content_set_tiers(builtin_tiers);
+}
+
+static bool content_load_pack(const ContentSource* source) {
+    ContentPackHeader header;
+    if(!source->read(source->ctx, 0, &header, sizeof(header))) return false;
+    if(header.magic != CONTENT_PACK_MAGIC || header.version != CONTENT_PACK_VERSION) return false;
+    if(header.packet_count == 0 || header.packet_count > CONTENT_MAX_PACKETS) return false;
+    if(header.world_count == 0 || header.world_count > CONTENT_MAX_WORLDS) return false;
+    if(header.tier_start[0] != 0 || header.tier_start[CONTENT_TIERS] != header.packet_count) return false;
+    for(int t=0; t<CONTENT_TIERS; t++) {
+        if(header.tier_start[t] > header.tier_start[t + 1]) return false;
+    }
+    size_t worlds_size = header.world_count * sizeof(ContentWorld);
+    if(!source->read(source->ctx, sizeof(header), registry.worlds, worlds_size)) return false;
+    for(int w=0; w<header.world_count; w++) {
+        registry.worlds[w].name[CONTENT_NAME_LEN - 1] = '\0';
+        if(registry.worlds[w].scene > 4) registry.worlds[w].scene = 0;
+    }
+    registry.source = *source;
+    registry.from_pack = true;
+    registry.packet_count = header.packet_count;
+    registry.world_count = header.world_count;
+    registry.packets_offset = sizeof(header) + worlds_size;
+    uint16_t tier_start[CONTENT_TIERS + 1];
+    memcpy(tier_start, header.tier_start, sizeof(tier_start));
+    content_set_tiers(tier_start);
+    return true;
+}
+
+bool content_load(const ContentSource* source) {
+    for(int i=0; i<CONTENT_CACHE_SLOTS; i++) {
+        registry.cache_tag[i] = 0xFFFF;
+        registry.cache_age[i] = 0;
+    }
+    if(source && content_load_pack(source)) return true;
+    content_use_builtin();
+    return false;
+}
+
+uint16_t content_packet_count(void) {
+    return registry.packet_count;
+}
+
+uint8_t content_world_count(void) {
+    return registry.world_count;
+}
+
+static void content_fetch(uint16_t idx, ContentPacket* out) {
+    int slot = -1;
+    int oldest = 0;
+    for(int i=0; i<CONTENT_CACHE_SLOTS; i++) {
+        if(registry.cache_tag[i] == idx) slot = i;
+        if(registry.cache_age[i] > registry.cache_age[oldest]) oldest = i;
+    }
+    if(slot < 0) {
+        slot = oldest;
+        ContentPacket* entry = &registry.cache[slot];
+        uint32_t offset = registry.packets_offset + (uint32_t)idx * sizeof(ContentPacket);
+        if(registry.source.read(registry.source.ctx, offset, entry, sizeof(ContentPacket))) {
+            entry->name[CONTENT_NAME_LEN - 1] = '\0';
+            entry->desc_a[CONTENT_NAME_LEN - 1] = '\0';
+            entry->desc_b[CONTENT_NAME_LEN - 1] = '\0';
+        } else {
+            memset(entry, 0, sizeof(ContentPacket));
+            strcpy(entry->name, "???");
+        }
+        registry.cache_tag[slot] = idx;
+    }
+    for(int i=0; i<CONTENT_CACHE_SLOTS; i++) if(registry.cache_age[i] < 0xFF) registry.cache_age[i]++;
+    registry.cache_age[slot] = 0;
+    *out = registry.cache[slot];
+}
+
+void content_packet(uint16_t idx, ContentPacket* out) {
+    if(idx >= registry.packet_count) idx = 0;
+    if(!registry.from_pack) {
+        *out = builtin_packets[idx];
+        return;
+    }
+    content_lock();
+    content_fetch(idx, out);
+    content_unlock();
+}
+
+uint32_t content_price(uint16_t idx) {
+    ContentPacket packet;
+    content_packet(idx, &packet);
+    return packet.price;
+}
+
+const ContentWorld* content_world(uint8_t idx) {
+    if(idx >= registry.world_count) idx = 0;
+    return &registry.worlds[idx];
+}
+
+void content_tier_range(int tier, uint16_t* first, uint16_t* count) {
+    if(tier < 0) tier = 0;
+    if(tier >= CONTENT_TIERS) tier = CONTENT_TIERS - 1;
+    *first = registry.tier_first[tier];
+    *count = registry.tier_count[tier];
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Content registry. Packet and world definitions come from the built-in
+ * tables or from a binary asset pack on the SD card. Packets are streamed
+ * from the pack on demand through a small cache, so RAM use does not grow
+ * with the catalog; only the (few) worlds are kept resident.
+ *
+ * Pack layout, all little-endian:
+ *
+ *   ContentPackHeader
+ *   ContentWorldRecord[world_count]
+ *   ContentPacketRecord[packet_count], sorted by rarity tier
+ *
+ * tier_start[t] is the index of the first packet of tier t and
+ * tier_start[CONTENT_TIERS] == packet_count.
+ */
+
+#define CONTENT_MAX_PACKETS 256
+#define CONTENT_MAX_WORLDS 16
+#define CONTENT_TIERS 7
+#define CONTENT_NAME_LEN 12
+#define CONTENT_CACHE_SLOTS 8
+
+#define CONTENT_PACK_MAGIC 0x4B504643u /* "CFPK" */
+#define CONTENT_PACK_VERSION 1
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t packet_count;
+    uint8_t world_count;
+    uint8_t reserved[3];
+    uint16_t tier_start[CONTENT_TIERS + 1];
+} ContentPackHeader;
+
+typedef struct __attribute__((packed)) {
+    char name[CONTENT_NAME_LEN];
+    char desc_a[CONTENT_NAME_LEN];
+    char desc_b[CONTENT_NAME_LEN];
+    uint32_t price;
+} ContentPacketRecord;
+
+typedef struct __attribute__((packed)) {
+    char name[CONTENT_NAME_LEN];
+    uint32_t cost;
+    uint8_t scene; /* Background style, 0..4 */
+    uint8_t depth; /* Scales rarity and timers like the world index used to */
+    uint16_t reserved;
+} ContentWorldRecord;
+
+typedef ContentPacketRecord ContentPacket;
+typedef ContentWorldRecord ContentWorld;
+
+/*
+ * Random-access byte source for a pack. lock/unlock may be NULL; when set
+ * they serialize reads between the main loop and the GUI thread.
+ */
+typedef struct {
+    bool (*read)(void* ctx, uint32_t offset, void* buf, size_t len);
+    void (*lock)(void* ctx);
+    void (*unlock)(void* ctx);
+    void* ctx;
+} ContentSource;
+
+/*
+ * Switches to the pack behind source, or to the built-in content if source
+ * is NULL or the pack is invalid. Returns true if the pack was accepted.
+ */
+bool content_load(const ContentSource* source);
+
+uint16_t content_packet_count(void);
+uint8_t content_world_count(void);
+
+/* Copies a packet definition out of the cache, reading the pack on a miss */
+void content_packet(uint16_t idx, ContentPacket* out);
+uint32_t content_price(uint16_t idx);
+
+const ContentWorld* content_world(uint8_t idx);
+
+/* First packet and packet count of a rarity tier; empty tiers borrow a neighbour */
+void content_tier_range(int tier, uint16_t* first, uint16_t* count);
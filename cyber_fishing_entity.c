@@ -0,0 +1,120 @@
+#include "cyber_fishing_entity.h"
+#include "cyber_fishing_content.h"
+
+const uint8_t entity_sprites[2][RARITY_TIERS][ENTITY_SPRITE_H] = {
+    {
+        {0x00, 0x32, 0x7E, 0x32, 0x00},
+        {0x00, 0x39, 0xFF, 0x39, 0x00},
+        {0x38, 0x45, 0x53, 0x45, 0x38},
+        {0x00, 0x60, 0x9F, 0x6A, 0x00},
+        {0x2A, 0x7F, 0x2A, 0x7F, 0x2A},
+        {0x18, 0x24, 0x42, 0x24, 0x18},
+        {0xB5, 0x56, 0xED, 0x5A, 0x4B},
+    },
+    {
+        {0x00, 0x4C, 0x7E, 0x4C, 0x00},
+        {0x00, 0x9C, 0xFF, 0x9C, 0x00},
+        {0x1C, 0xA2, 0xCA, 0xA2, 0x1C},
+        {0x00, 0x06, 0xF9, 0x56, 0x00},
+        {0x54, 0xFE, 0x54, 0xFE, 0x54},
+        {0x18, 0x24, 0x42, 0x24, 0x18},
+        {0xAD, 0x6A, 0xB7, 0x5A, 0xD2},
+    },
+};
+
+/* Per-spawn PRNG state, a pure function of the slot and its generation */
+static uint32_t entity_rng(const EntityPool* pool, int i) {
+    uint32_t h = pool->seed ^ ((uint32_t)i * 0x9E3779B9u) ^ ((uint32_t)pool->gen[i] * 0x85EBCA6Bu);
+    h ^= h >> 16;
+    h *= 0x7FEB352Du;
+    h ^= h >> 15;
+    h *= 0x846CA68Bu;
+    h ^= h >> 16;
+    return rng_seed_state(h);
+}
+
+/* Clock time at which entity i is fully off screen */
+static uint32_t entity_exit_time(const EntityPool* pool, int i) {
+    int32_t v = pool->vx[i];
+    int32_t dist = v > 0 ? ENTITY_SCREEN_W - pool->x0[i] : pool->x0[i] + ENTITY_SPRITE_W;
+    if(v < 0) v = -v;
+    /* Round up, so x(exit) is past the edge */
+    return pool->t0[i] + (uint32_t)(((int64_t)dist * 256000 + v - 1) / v);
+}
+
+/* Generation 0 starts anywhere on screen, later ones enter from an edge */
+static void entity_spawn(EntityPool* pool, const RarityTable* rarity, int i, uint32_t now) {
+    uint32_t rng = entity_rng(pool, i);
+    bool left = rng_next(&rng) & 1;
+    int16_t speed = ENTITY_SPEED_MIN + rng_range(&rng, ENTITY_SPEED_SPAN);
+    pool->vx[i] = left ? -speed : speed;
+    pool->y[i] = ENTITY_WATER_TOP + rng_range(&rng, ENTITY_WATER_ROWS);
+    if(pool->gen[i] == 0) pool->x0[i] = rng_range(&rng, ENTITY_SCREEN_W);
+    else pool->x0[i] = left ? ENTITY_SCREEN_W : -ENTITY_SPRITE_W;
+    pool->t0[i] = now;
+    pool->exit_at[i] = entity_exit_time(pool, i);
+    uint16_t first, count;
+    pool->tier[i] = rarity_sample(rarity, &rng);
+    content_tier_range(pool->tier[i], &first, &count);
+    pool->pkt[i] = first + (count > 1 ? rng_range(&rng, count) : 0);
+}
+
+void entity_pool_spawn(EntityPool* pool, const RarityTable* rarity, int world, uint16_t count, uint32_t now) {
+    pool->world = world;
+    pool->hooked = -1;
+    pool->count = count < ENTITY_MAX ? count : ENTITY_MAX;
+    for(int i=0; i<pool->count; i++) {
+        pool->gen[i] = 0;
+        entity_spawn(pool, rarity, i, now);
+    }
+}
+
+void entity_pool_update(EntityPool* pool, const RarityTable* rarity, uint32_t now) {
+    for(int i=0; i<pool->count; i++) {
+        if(i == pool->hooked) continue;
+        while((int32_t)(now - pool->exit_at[i]) >= 0) {
+            pool->gen[i]++;
+            entity_spawn(pool, rarity, i, pool->exit_at[i]);
+        }
+    }
+}
+
+int entity_pool_nearest(const EntityPool* pool, int x, uint32_t now) {
+    int best = -1, best_dist = 0;
+    for(int i=0; i<pool->count; i++) {
+        int ex = entity_x(pool, i, now);
+        if(ex <= -ENTITY_SPRITE_W || ex >= ENTITY_SCREEN_W) continue;
+        int dist = ex + ENTITY_SPRITE_W / 2 - x;
+        if(dist < 0) dist = -dist;
+        if(best < 0 || dist < best_dist) {
+            best = i;
+            best_dist = dist;
+        }
+    }
+    return best;
+}
+
+void entity_pool_hook(EntityPool* pool, int i) {
+    pool->hooked = i;
+}
+
+void entity_pool_release(EntityPool* pool, const RarityTable* rarity, uint32_t now) {
+    if(pool->hooked < 0) return;
+    int i = pool->hooked;
+    pool->hooked = -1;
+    pool->gen[i]++;
+    entity_spawn(pool, rarity, i, now);
+}
+
+uint16_t entity_pool_visible(const EntityPool* pool, uint32_t now, EntitySprite* out) {
+    uint16_t n = 0;
+    for(int i=0; i<pool->count; i++) {
+        int x = i == pool->hooked ? ENTITY_HOOK_X - ENTITY_SPRITE_W / 2 : entity_x(pool, i, now);
+        if(x <= -ENTITY_SPRITE_W || x >= ENTITY_SCREEN_W) continue;
+        out[n].x = x;
+        out[n].y = i == pool->hooked ? ENTITY_HOOK_Y : pool->y[i];
+        out[n].bits = entity_sprites[pool->vx[i] < 0][pool->tier[i]];
+        n++;
+    }
+    return n;
+}
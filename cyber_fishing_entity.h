@@ -0,0 +1,83 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "cyber_fishing_rarity.h"
+
+/*
+ * Packets swimming in the fishing view. A fixed pool of entities stored as
+ * parallel arrays, so an update or a draw walks a few tight arrays and
+ * nothing is allocated per frame.
+ *
+ * An entity's position is a closed-form function of the game clock:
+ * x(t) = x0 + vx * (t - t0). When it leaves the screen it respawns at the
+ * far edge at the exact exit time, with parameters hashed from (seed,
+ * slot, generation). The pool therefore ends up in the same state however
+ * often it is updated, which keeps recordings deterministic. Tiers are drawn
+ * from the current rarity table, so the mix in the water matches the world.
+ */
+
+#ifndef ENTITY_MAX
+#define ENTITY_MAX 16
+#endif
+
+#define ENTITY_SPRITE_W 8
+#define ENTITY_SPRITE_H 5
+#define ENTITY_SCREEN_W 128
+/* Band of water the packets swim in */
+#define ENTITY_WATER_TOP 44
+#define ENTITY_WATER_ROWS 14
+/* Where the line meets the water; a hooked packet is drawn here */
+#define ENTITY_HOOK_X 70
+#define ENTITY_HOOK_Y 50
+/* Speeds in px/s, as Q8 fixed point */
+#define ENTITY_SPEED_MIN (6 << 8)
+#define ENTITY_SPEED_SPAN (18 << 8)
+
+typedef struct {
+    uint32_t seed;
+    int8_t world; /* -1 until spawned */
+    int16_t hooked; /* Slot on the line, or -1 */
+    uint16_t count;
+    int16_t x0[ENTITY_MAX];
+    uint32_t t0[ENTITY_MAX];
+    uint32_t exit_at[ENTITY_MAX]; /* Clock time it is fully off screen */
+    int16_t vx[ENTITY_MAX]; /* Q8 px/s; the sign is the direction */
+    uint8_t y[ENTITY_MAX];
+    uint8_t tier[ENTITY_MAX];
+    uint16_t pkt[ENTITY_MAX];
+    uint16_t gen[ENTITY_MAX];
+} EntityPool;
+
+/* One on-screen entity, ready to blit */
+typedef struct {
+    int16_t x;
+    uint8_t y;
+    const uint8_t* bits;
+} EntitySprite;
+
+/* XBM sprites per direction (0: swimming right) and rarity tier */
+extern const uint8_t entity_sprites[2][RARITY_TIERS][ENTITY_SPRITE_H];
+
+/* Fills the pool with count entities scattered across the screen */
+void entity_pool_spawn(EntityPool* pool, const RarityTable* rarity, int world, uint16_t count, uint32_t now);
+
+/* Respawns every entity that swam off screen up to now */
+void entity_pool_update(EntityPool* pool, const RarityTable* rarity, uint32_t now);
+
+static inline int entity_x(const EntityPool* pool, int i, uint32_t now) {
+    return pool->x0[i] + (int32_t)(((int64_t)pool->vx[i] * (int32_t)(now - pool->t0[i])) / 256000);
+}
+
+/* Entity nearest to x that is on screen at now, or -1 */
+int entity_pool_nearest(const EntityPool* pool, int x, uint32_t now);
+
+/* Stops an entity at the hook until entity_pool_release() */
+void entity_pool_hook(EntityPool* pool, int i);
+
+/* Sends the hooked entity back out from the edge at now */
+void entity_pool_release(EntityPool* pool, const RarityTable* rarity, uint32_t now);
+
+/* Culls off-screen entities and writes the rest to out. Returns how many. */
+uint16_t entity_pool_visible(const EntityPool* pool, uint32_t now, EntitySprite* out);
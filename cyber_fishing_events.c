@@ -0,0 +1,22 @@
+#include "cyber_fishing_events.h"
+
+bool event_subscribe(EventBus* bus, GameEventType type, EventHandler handler, uint16_t arg) {
+    if(type >= GameEventTypes || bus->count >= EVENT_MAX_SUBSCRIBERS) return false;
+    uint16_t id = bus->count++;
+    bus->handler[id] = handler;
+    bus->arg[id] = arg;
+    bus->next[id] = 0;
+    if(bus->tail[type]) bus->next[bus->tail[type] - 1] = id + 1;
+    else bus->head[type] = id + 1;
+    bus->tail[type] = id + 1;
+    return true;
+}
+
+bool event_publish(const EventBus* bus, void* target, const GameEvent* event) {
+    if(event->type >= GameEventTypes) return false;
+    bool notable = false;
+    for(uint16_t id = bus->head[event->type]; id; id = bus->next[id - 1]) {
+        notable |= bus->handler[id - 1](target, event, bus->arg[id - 1]);
+    }
+    return notable;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Game event bus. The catch, sell, buy, travel and prestige handlers
+ * publish a typed event; subscribers register per event type, so a
+ * publish only walks the subscribers of that one type and a step with no
+ * events costs nothing. Subscriptions are made once at startup and are
+ * read-only afterwards, so several game instances (the balance simulator's
+ * threads) can publish concurrently.
+ */
+
+#ifndef EVENT_MAX_SUBSCRIBERS
+#define EVENT_MAX_SUBSCRIBERS 64
+#endif
+
+typedef enum {
+    GameEventCatch,
+    GameEventSell,
+    GameEventBuy,
+    GameEventTravel,
+    GameEventPrestige,
+    GameEventTypes,
+} GameEventType;
+
+/* What a GameEventBuy bought */
+typedef enum {
+    GameBuyBuffer,
+    GameBuyAntenna,
+    GameBuyLure,
+    GameBuyWorld,
+} GameBuyItem;
+
+typedef struct {
+    uint8_t type; /* GameEventType */
+    uint8_t world; /* Where it happened; the destination for travel or a world bought */
+    uint8_t subject; /* Catch: rarity tier; buy: GameBuyItem */
+    uint16_t pkt; /* Catch: packet index */
+    uint32_t count; /* Packets caught or sold, level bought, or core version reached */
+    uint32_t credits; /* Earned by a sale, spent on a purchase */
+} GameEvent;
+
+/*
+ * target is the state the publisher passed in, arg is fixed at
+ * subscription. Returns true if the player should be told about the
+ * outcome, such as an achievement unlocking.
+ */
+typedef bool (*EventHandler)(void* target, const GameEvent* event, uint16_t arg);
+
+/* A zeroed bus is empty and valid */
+typedef struct {
+    EventHandler handler[EVENT_MAX_SUBSCRIBERS];
+    uint16_t arg[EVENT_MAX_SUBSCRIBERS];
+    /* Per-type chains in subscription order, as index + 1; 0 ends a chain */
+    uint16_t next[EVENT_MAX_SUBSCRIBERS];
+    uint16_t head[GameEventTypes];
+    uint16_t tail[GameEventTypes];
+    uint16_t count;
+} EventBus;
+
+/* Handlers of one type run in the order they subscribed. False when the bus is full. */
+bool event_subscribe(EventBus* bus, GameEventType type, EventHandler handler, uint16_t arg);
+
+/* Runs every handler subscribed to event->type; true if any of them returned true */
+bool event_publish(const EventBus* bus, void* target, const GameEvent* event);
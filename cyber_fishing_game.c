@@ -0,0 +1,467 @@
+#include "cyber_fishing_game.h"
+
+#include <string.h>
+
+const char* const prestige_icons[10] = {"[X]", "[O]", "[#]", "[@]", "[&]", "[%]", "[*]", "[!]", "[?]", "[S]"};
+
+/* Splash and the fishing view run timers or animate draw_world_bg; menus are static */
+static const uint32_t state_frame_ms[] = {
+    [StateSplash] = GAME_TICK_MS,
+    [StateWaiting] = GAME_TICK_MS,
+    [StateFishing] = GAME_TICK_MS,
+    [StateBite] = GAME_TICK_MS,
+    [StateCaught] = GAME_TICK_MS,
+    [StateLost] = GAME_TICK_MS,
+    [StateShop] = 0,
+    [StateSell] = 0,
+    [StateIndex] = 0,
+    [StateWorldShop] = 0,
+    [StatePrestige] = 0,
+    [StateDevMenu] = 0,
+    [StatePerf] = 500,
+    [StateSettings] = 0,
+    [StateStats] = 0,
+};
+static const uint32_t splash_ms[GAME_SPLASH_STEPS] = {GAME_SPLASH_MS, 1000, 500, 0};
+static const GameKey cheat_seq[] = {GameKeyUp, GameKeyUp, GameKeyDown, GameKeyDown, GameKeyLeft, GameKeyRight};
+
+/* Filled once by game_events_init(), then only read */
+static EventBus game_bus;
+
+void game_events_init(void) {
+    achievements_subscribe(&game_bus, achievement_rules, achievement_rule_count);
+}
+
+static uint32_t game_publish(CyberFishApp* app, const GameEvent* event) {
+    if(!event_publish(&game_bus, &app->progress.achievements, event)) return GameEffectNone;
+    return GameEffectAchievement | GameEffectSave;
+}
+
+void reset_game(CyberFishApp* app) {
+    app->progress.credits = 0;
+    app->progress.buffer_lvl = 1;
+    app->progress.antenna_lvl = 1;
+    app->progress.lure_lvl = 1;
+    app->progress.current_world = 0;
+    app->progress.inv_used = 0;
+    memset(app->progress.inv, 0, sizeof(app->progress.inv));
+    memset(app->progress.discovered, 0, sizeof(app->progress.discovered));
+    app->progress.world_unlocked = 1 << 0;
+    app->ui.discovered_count = 0;
+}
+
+void game_sync_discovered(CyberFishApp* app) {
+    uint16_t count = 0;
+    for(int w=0; w<DISCOVERED_WORDS; w++) count += __builtin_popcount(app->progress.discovered[w]);
+    app->ui.discovered_count = count;
+}
+
+static void game_discover(CyberFishApp* app, uint16_t pkt) {
+    if(game_discovered(app, pkt)) return;
+    app->progress.discovered[pkt >> 5] |= 1u << (pkt & 31);
+    app->ui.discovered_count++;
+}
+
+static void game_discover_all(CyberFishApp* app) {
+    uint16_t count = content_packet_count();
+    memset(app->progress.discovered, 0, sizeof(app->progress.discovered));
+    for(uint16_t w=0; w < (count + 31) / 32; w++) {
+        uint16_t bits = count - w * 32;
+        app->progress.discovered[w] = bits >= 32 ? 0xFFFFFFFFu : (1u << bits) - 1;
+    }
+    app->ui.discovered_count = count;
+}
+
+static uint16_t game_all_worlds_mask(void) {
+    return (uint16_t)((1u << content_world_count()) - 1);
+}
+
+/*
+ * Stores a catch. If the hold has no free stack for a new packet type the
+ * catch is sold on the spot; returns false in that case.
+ */
+static bool inv_add(CyberFishApp* app, uint16_t pkt, uint32_t count) {
+    CyberFishProgress* pr = &app->progress;
+    for(int i=0; i<pr->inv_used; i++) {
+        if(pr->inv[i].pkt != pkt) continue;
+        uint32_t room = UINT32_MAX - pr->inv[i].count;
+        pr->inv[i].count += count < room ? count : room;
+        return true;
+    }
+    if(pr->inv_used < INV_SLOTS) {
+        pr->inv[pr->inv_used].pkt = pkt;
+        pr->inv[pr->inv_used].count = count;
+        pr->inv_used++;
+        return true;
+    }
+    game_add_credits(app, (uint64_t)game_price(pkt, pr->core_ver) * count);
+    return false;
+}
+
+/* Drops an emptied stack, keeping the remaining stacks in order */
+static void inv_compact(CyberFishApp* app, int slot) {
+    CyberFishProgress* pr = &app->progress;
+    memmove(&pr->inv[slot], &pr->inv[slot + 1], (pr->inv_used - slot - 1) * sizeof(InvStack));
+    pr->inv_used--;
+    memset(&pr->inv[pr->inv_used], 0, sizeof(InvStack));
+    if(app->ui.shop_cursor >= pr->inv_used && pr->inv_used > 0) app->ui.shop_cursor = pr->inv_used - 1;
+    if(pr->inv_used == 0) app->ui.shop_cursor = 0;
+}
+
+uint32_t game_price(uint16_t pkt, uint32_t core_ver) {
+    /* base * (1 + bonus*(v-1)); with the default 25% this is base * (v+3) / 4 */
+    uint64_t scale = 100 + (int64_t)PRESTIGE_BONUS_PCT * ((int64_t)core_ver - 1);
+    uint64_t price = (uint64_t)content_price(pkt) * scale / 100;
+    return price > UINT32_MAX ? UINT32_MAX : (uint32_t)price;
+}
+
+void game_add_credits(CyberFishApp* app, uint64_t amount) {
+    uint64_t total = (uint64_t)app->progress.credits + amount;
+    app->progress.credits = total > UINT32_MAX ? UINT32_MAX : (uint32_t)total;
+}
+
+void game_add_packets(CyberFishApp* app, uint16_t pkt, uint32_t count) {
+    if(count == 0) return;
+    inv_add(app, pkt, count);
+    game_discover(app, pkt);
+}
+
+int32_t game_cast_base_ms(const CyberFishApp* app) {
+    return 1000 - (app->progress.lure_lvl * 200) - (game_world(app)->depth * 300);
+}
+
+/* Sells the whole stack of one packet type, or of every type, as one transaction */
+static uint32_t game_sell_bulk(CyberFishApp* app, bool all_types) {
+    CyberFishProgress* pr = &app->progress;
+    if(pr->inv_used == 0 || (!all_types && app->ui.shop_cursor >= pr->inv_used)) return GameEffectNone;
+    uint64_t total = 0;
+    uint64_t packets = 0;
+    if(all_types) {
+        for(int i=0; i<pr->inv_used; i++) {
+            total += (uint64_t)game_price(pr->inv[i].pkt, pr->core_ver) * pr->inv[i].count;
+            packets += pr->inv[i].count;
+        }
+        pr->inv_used = 0;
+        memset(pr->inv, 0, sizeof(pr->inv));
+        app->ui.shop_cursor = 0;
+    } else {
+        InvStack* stack = &pr->inv[app->ui.shop_cursor];
+        total = (uint64_t)game_price(stack->pkt, pr->core_ver) * stack->count;
+        packets = stack->count;
+        inv_compact(app, app->ui.shop_cursor);
+    }
+    game_add_credits(app, total);
+    GameEvent event = {
+        .type = GameEventSell,
+        .world = pr->current_world,
+        .count = packets > UINT32_MAX ? UINT32_MAX : (uint32_t)packets,
+        .credits = total > UINT32_MAX ? UINT32_MAX : (uint32_t)total,
+    };
+    return GameEffectSave | game_publish(app, &event);
+}
+
+void game_init(CyberFishApp* app) {
+    memset(app, 0, sizeof(CyberFishApp));
+    app->rarity.world = -1;
+    app->fish.world = -1;
+}
+
+void game_start(CyberFishApp* app, uint32_t now) {
+    app->ui.current_state = StateSplash;
+    app->ui.now_ms = now;
+    app->ui.deadline = now + game_splash_ms(app);
+    app->ui.cheat_step = 0;
+    app->ui.bite_pkt = 0;
+    app->fish.world = -1;
+    app->ui.recording = false;
+    app->ui.dev_status[0] = '\0';
+}
+
+uint32_t game_splash_ms(const CyberFishApp* app) {
+    return splash_ms[(app->progress.settings & SettingSplashMask) >> SettingSplashShift];
+}
+
+void game_seed(CyberFishApp* app, uint32_t seed) {
+    app->rng_state = rng_seed_state(seed);
+    /* A separate stream, so the water never shifts the game's own draws */
+    app->fish.seed = seed * 0x9E3779B9u + 0x7F4A7C15u;
+}
+
+uint32_t game_frame_interval(const CyberFishApp* app) {
+    uint8_t state = app->ui.current_state;
+    bool fishing_view = state >= StateWaiting && state <= StateLost;
+    if(fishing_view && (app->progress.settings & SettingSmoothFx)) return GAME_FRAME_FAST_MS;
+    return state_frame_ms[state];
+}
+
+static bool game_timer_running(const CyberFishApp* app) {
+    uint8_t state = app->ui.current_state;
+    return state == StateSplash || state == StateFishing || state == StateBite;
+}
+
+uint32_t game_timeout(const CyberFishApp* app, uint32_t now) {
+    if(!game_timer_running(app)) return GAME_NO_DEADLINE;
+    int32_t left = (int32_t)(app->ui.deadline - now);
+    return left > 0 ? (uint32_t)left : 0;
+}
+
+static uint32_t game_handle_input(CyberFishApp* app, const GameInput* input) {
+    uint32_t fx = GameEffectNone;
+    if(app->ui.current_state == StateWaiting) {
+        if(input->key == cheat_seq[app->ui.cheat_step]) {
+            app->ui.cheat_step++;
+            if(app->ui.cheat_step == 6) {
+                app->ui.current_state = StateDevMenu;
+                app->ui.dev_cursor = 0;
+                app->ui.cheat_step = 0;
+                app->ui.dev_status[0] = '\0';
+                fx |= GameEffectSuccess;
+            }
+        } else if(input->key != GameKeyOk) {
+            app->ui.cheat_step = 0;
+        }
+    }
+    if(input->type == GameInputLong) {
+        if(app->ui.current_state == StateSell && input->key == GameKeyOk) fx |= game_sell_bulk(app, false);
+        else if(app->ui.current_state == StateSell && input->key == GameKeyRight) fx |= game_sell_bulk(app, true);
+        return fx;
+    }
+    if(input->type != GameInputShort) return fx;
+
+    if(input->key == GameKeyBack) {
+        if(app->ui.current_state == StateWaiting || app->ui.current_state == StateSplash) {
+            fx |= GameEffectExit;
+        } else {
+            app->ui.current_state = StateWaiting;
+        }
+    } else if(app->ui.current_state == StateDevMenu) {
+        if(input->key == GameKeyDown) app->ui.dev_cursor = (app->ui.dev_cursor + 1) % DEV_MENU_ITEMS;
+        else if(input->key == GameKeyUp) app->ui.dev_cursor = (app->ui.dev_cursor - 1 + DEV_MENU_ITEMS) % DEV_MENU_ITEMS;
+        else if(input->key == GameKeyOk && app->ui.dev_cursor == 4) fx |= GameEffectRecord;
+        else if(input->key == GameKeyOk && app->ui.dev_cursor == 5) fx |= GameEffectReplay;
+        else if(input->key == GameKeyOk && app->ui.dev_cursor == 6) app->ui.current_state = StatePerf;
+        else if(input->key == GameKeyOk) {
+            if(app->ui.dev_cursor == 0) game_add_credits(app, 1000);
+            else if(app->ui.dev_cursor == 1) { app->progress.world_unlocked = game_all_worlds_mask(); }
+            else if(app->ui.dev_cursor == 2) {
+                app->progress.credits = 50000; app->progress.buffer_lvl = 8; app->progress.antenna_lvl = 8; app->progress.lure_lvl = 8;
+                app->progress.world_unlocked = game_all_worlds_mask();
+                game_discover_all(app);
+            } else if(app->ui.dev_cursor == 3) {
+                app->progress.core_ver = 1; reset_game(app);
+                memset(&app->progress.achievements, 0, sizeof(app->progress.achievements));
+            }
+            fx |= GameEffectSave | GameEffectBlink;
+        }
+    } else if(app->ui.current_state == StatePerf) {
+        if(input->key == GameKeyOk) fx |= GameEffectPerfCsv;
+    } else if(app->ui.current_state == StateIndex) {
+        uint16_t count = content_packet_count();
+        if(input->key == GameKeyDown) app->ui.index_cursor = (app->ui.index_cursor + 1) % count;
+        else if(input->key == GameKeyUp) app->ui.index_cursor = (app->ui.index_cursor + count - 1) % count;
+        else if(input->key == GameKeyRight) app->ui.index_cursor = (app->ui.index_cursor + INDEX_PAGE) % count;
+        else if(input->key == GameKeyLeft) app->ui.index_cursor = (app->ui.index_cursor + count - INDEX_PAGE % count) % count;
+    } else if(app->ui.current_state == StatePrestige) {
+        if(game_index_complete(app) && input->key == GameKeyOk && app->progress.core_ver < CORE_VER_MAX) {
+            app->progress.core_ver++;
+            reset_game(app);
+            app->ui.current_state = StateWaiting;
+            fx |= GameEffectSave | GameEffectSuccess;
+            GameEvent event = {.type = GameEventPrestige, .count = app->progress.core_ver};
+            fx |= game_publish(app, &event);
+        }
+    } else if(app->ui.current_state == StateShop) {
+        if(input->key == GameKeyRight) {
+            app->ui.current_state = StateWorldShop;
+            app->ui.shop_cursor = 0;
+        } else if(input->key == GameKeyLeft) {
+            app->ui.current_state = StatePrestige;
+        } else if(input->key == GameKeyDown) app->ui.shop_cursor = (app->ui.shop_cursor + 1) % 3;
+        else if(input->key == GameKeyUp) app->ui.shop_cursor = (app->ui.shop_cursor - 1 + 3) % 3;
+        else if(input->key == GameKeyOk) {
+            static const uint32_t cost[3] = {SHOP_BUFFER_COST, SHOP_ANTENNA_COST, SHOP_LURE_COST};
+            CyberFishProgress* pr = &app->progress;
+            uint8_t* levels[3] = {&pr->buffer_lvl, &pr->antenna_lvl, &pr->lure_lvl};
+            uint8_t item = app->ui.shop_cursor;
+            if(pr->credits >= cost[item] && *levels[item] < LEVEL_MAX) {
+                pr->credits -= cost[item];
+                (*levels[item])++;
+                GameEvent event = {
+                    .type = GameEventBuy, .world = pr->current_world, .subject = item, .count = *levels[item], .credits = cost[item],
+                };
+                fx |= game_publish(app, &event);
+            }
+            fx |= GameEffectSave;
+        }
+    } else if(app->ui.current_state == StateWorldShop) {
+        if(input->key == GameKeyLeft) {
+            app->ui.current_state = StateShop;
+            app->ui.shop_cursor = 0;
+        } else if(input->key == GameKeyDown) app->ui.shop_cursor = (app->ui.shop_cursor + 1) % content_world_count();
+        else if(input->key == GameKeyUp) app->ui.shop_cursor = (app->ui.shop_cursor - 1 + content_world_count()) % content_world_count();
+        else if(input->key == GameKeyOk) {
+            uint32_t cost = content_world(app->ui.shop_cursor)->cost;
+            GameEvent event = {.world = app->ui.shop_cursor, .count = 1};
+            if(!game_world_unlocked(app, app->ui.shop_cursor) && app->progress.credits >= cost) {
+                app->progress.credits -= cost;
+                app->progress.world_unlocked |= 1 << app->ui.shop_cursor;
+                event.type = GameEventBuy;
+                event.subject = GameBuyWorld;
+                event.count = __builtin_popcount(app->progress.world_unlocked);
+                event.credits = cost;
+                fx |= game_publish(app, &event);
+            } else if(game_world_unlocked(app, app->ui.shop_cursor)) {
+                app->progress.current_world = app->ui.shop_cursor;
+                app->ui.current_state = StateWaiting;
+                event.type = GameEventTravel;
+                fx |= game_publish(app, &event);
+            }
+            fx |= GameEffectSave;
+        }
+    } else if(app->ui.current_state == StateSell) {
+        CyberFishProgress* pr = &app->progress;
+        if(pr->inv_used == 0) {
+            /* Nothing to browse or sell */
+        } else if(input->key == GameKeyDown) app->ui.shop_cursor = (app->ui.shop_cursor + 1) % pr->inv_used;
+        else if(input->key == GameKeyUp) app->ui.shop_cursor = (app->ui.shop_cursor - 1 + pr->inv_used) % pr->inv_used;
+        else if(input->key == GameKeyOk) {
+            InvStack* stack = &pr->inv[app->ui.shop_cursor];
+            GameEvent event = {.type = GameEventSell, .world = pr->current_world, .count = 1, .credits = game_price(stack->pkt, pr->core_ver)};
+            game_add_credits(app, event.credits);
+            if(--stack->count == 0) inv_compact(app, app->ui.shop_cursor);
+            fx |= GameEffectSave | game_publish(app, &event);
+        }
+    } else if(app->ui.current_state == StateWaiting) {
+        if(input->key == GameKeyUp) { app->ui.current_state = StateShop; app->ui.shop_cursor = 0; }
+        else if(input->key == GameKeyDown) { app->ui.current_state = StateSell; app->ui.shop_cursor = 0; }
+        else if(input->key == GameKeyLeft) { app->ui.current_state = StateIndex; app->ui.index_cursor = 0; }
+        else if(input->key == GameKeyRight) { app->ui.current_state = StateSettings; app->ui.shop_cursor = 0; }
+        else if(input->key == GameKeyOk) {
+            int32_t wait = (int32_t)rng_range(&app->rng_state, GAME_CAST_SPREAD_MS) + game_cast_base_ms(app);
+            app->ui.current_state = StateFishing;
+            app->ui.deadline = input->time + (wait > GAME_TICK_MS ? (uint32_t)wait : GAME_TICK_MS);
+        }
+    } else if(app->ui.current_state == StateSettings) {
+        if(input->key == GameKeyDown) app->ui.shop_cursor = (app->ui.shop_cursor + 1) % SETTINGS_ITEMS;
+        else if(input->key == GameKeyUp) app->ui.shop_cursor = (app->ui.shop_cursor - 1 + SETTINGS_ITEMS) % SETTINGS_ITEMS;
+        else if(input->key == GameKeyOk) {
+            if(app->ui.shop_cursor == 0) {
+                app->progress.settings ^= SettingSmoothFx;
+                fx |= GameEffectSave;
+            } else if(app->ui.shop_cursor == 1) {
+                /* The save this triggers restamps saved_at, so no idle time is credited retroactively */
+                app->progress.settings ^= SettingAutoTrawler;
+                fx |= GameEffectSave;
+            } else if(app->ui.shop_cursor == 2) {
+                uint8_t step = ((app->progress.settings & SettingSplashMask) >> SettingSplashShift) + 1;
+                app->progress.settings &= ~SettingSplashMask;
+                app->progress.settings |= (step % GAME_SPLASH_STEPS) << SettingSplashShift;
+                fx |= GameEffectSave;
+            } else if(app->ui.shop_cursor == 3) {
+                app->ui.current_state = StateStats;
+                app->ui.shop_cursor = 0;
+            }
+        }
+    } else if(app->ui.current_state == StateStats) {
+        uint8_t worlds = content_world_count();
+        uint8_t last = worlds > STATS_ROWS ? worlds - STATS_ROWS : 0;
+        if(input->key == GameKeyDown && app->ui.shop_cursor < last) app->ui.shop_cursor++;
+        else if(input->key == GameKeyUp && app->ui.shop_cursor > 0) app->ui.shop_cursor--;
+    } else if(app->ui.current_state == StateBite && input->key == GameKeyOk) {
+        app->ui.last_catch_sold = !inv_add(app, app->ui.bite_pkt, 1);
+        game_discover(app, app->ui.bite_pkt);
+        app->ui.last_catch_idx = app->ui.bite_pkt;
+        app->ui.current_state = StateCaught;
+        fx |= GameEffectCatch | GameEffectSave;
+        GameEvent event = {
+            .type = GameEventCatch, .world = app->progress.current_world, .subject = app->ui.bite_tier, .pkt = app->ui.bite_pkt, .count = 1,
+        };
+        fx |= game_publish(app, &event);
+    } else if(app->ui.current_state == StateLost && input->key == GameKeyOk && input->time - app->ui.deadline < GAME_LOST_HOLD_MS) {
+        /* A reel-in just after the window closed is the miss itself, not a dismissal of it */
+    } else if((app->ui.current_state == StateCaught || app->ui.current_state == StateLost) && input->key == GameKeyOk) {
+        app->ui.current_state = StateWaiting;
+    }
+    return fx;
+}
+
+void game_sync_rarity(CyberFishApp* app) {
+    int depth = game_world(app)->depth;
+    if(app->rarity.antenna_lvl != app->progress.antenna_lvl || app->rarity.world != depth) {
+        rarity_table_build(&app->rarity, app->progress.antenna_lvl, depth);
+    }
+}
+
+/* Brings the water up to clock time t; a new world gets a fresh school */
+static void game_advance_fish(CyberFishApp* app, uint32_t t) {
+    game_sync_rarity(app);
+    if(app->fish.world != app->progress.current_world) {
+        /* The first school dates from game_start, however late the first step comes */
+        uint32_t born = app->fish.world < 0 ? app->ui.now_ms : t;
+        entity_pool_spawn(&app->fish, &app->rarity, app->progress.current_world, ENTITY_MAX, born);
+        entity_pool_update(&app->fish, &app->rarity, t);
+    } else {
+        entity_pool_update(&app->fish, &app->rarity, t);
+    }
+}
+
+/* Bite window in ms; every buffer level buys 500 ms, every depth step costs 300 */
+static uint32_t game_bite_window(const CyberFishApp* app) {
+    int32_t window = 2000 + (app->progress.buffer_lvl * 500) - (game_world(app)->depth * 300);
+    return window > GAME_TICK_MS ? (uint32_t)window : GAME_TICK_MS;
+}
+
+/*
+ * Fires every timer that expired by now. Each deadline is set from the one
+ * before it rather than from the step that noticed it, so a step that runs
+ * late still lands in the same state as one that ran on time.
+ */
+static uint32_t game_handle_timers(CyberFishApp* app, uint32_t now) {
+    uint32_t fx = GameEffectNone;
+    while(game_timer_running(app) && (int32_t)(now - app->ui.deadline) >= 0) {
+        game_advance_fish(app, app->ui.deadline);
+        if(app->ui.current_state == StateSplash) {
+            app->ui.current_state = StateWaiting;
+        } else if(app->ui.current_state == StateFishing) {
+            app->ui.current_state = StateBite;
+            fx |= GameEffectBite;
+            app->ui.bite_at = app->ui.deadline;
+            app->ui.deadline = app->ui.bite_at + game_bite_window(app);
+            /* Whatever swims closest to the line bites; tiers in the water follow the rarity table */
+            int hooked = entity_pool_nearest(&app->fish, ENTITY_HOOK_X, app->ui.bite_at);
+            if(hooked >= 0) {
+                entity_pool_hook(&app->fish, hooked);
+                app->ui.bite_tier = app->fish.tier[hooked];
+                app->ui.bite_pkt = app->fish.pkt[hooked];
+            } else {
+                uint16_t first, count;
+                app->ui.bite_tier = rarity_sample(&app->rarity, &app->rng_state);
+                content_tier_range(app->ui.bite_tier, &first, &count);
+                app->ui.bite_pkt = first + (count > 1 ? rng_range(&app->rng_state, count) : 0);
+            }
+        } else {
+            app->ui.current_state = StateLost;
+            entity_pool_release(&app->fish, &app->rarity, app->ui.deadline);
+            fx |= GameEffectFail;
+        }
+    }
+    game_advance_fish(app, now);
+    /* The clock never runs backwards, even if a caller passes a stale time */
+    if((int32_t)(now - app->ui.now_ms) > 0) app->ui.now_ms = now;
+    return fx;
+}
+
+uint32_t game_step(CyberFishApp* app, const GameInput* input, uint32_t now) {
+    uint32_t fx = GameEffectNone;
+    if(input) {
+        app->ui.trawled = 0;
+        fx |= game_handle_timers(app, input->time);
+        fx |= game_handle_input(app, input);
+        /* Reeled in or walked away; either way the packet leaves the line */
+        if(app->ui.current_state != StateBite) entity_pool_release(&app->fish, &app->rarity, input->time);
+        /* Travel and upgrades take effect in the water at the input's time, not the step's */
+        game_advance_fish(app, input->time);
+    }
+    fx |= game_handle_timers(app, now);
+    return fx;
+}
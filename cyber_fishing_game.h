@@ -0,0 +1,251 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "cyber_fishing_achievements.h"
+#include "cyber_fishing_content.h"
+#include "cyber_fishing_entity.h"
+#include "cyber_fishing_rarity.h"
+
+/*
+ * Game core. Everything in here is plain C over CyberFishApp with no furi,
+ * gui or storage dependencies, so the state machine can be stepped without
+ * a view port or message queue behind it.
+ */
+
+/*
+ * Game timers are deadlines on a monotonic millisecond clock (furi_get_tick
+ * on the device), so they run at the same speed however often the game is
+ * stepped. GAME_TICK_MS is only the default redraw period.
+ */
+#define GAME_TICK_MS 100
+/* Redraw period of the fishing view with SettingSmoothFx on */
+#define GAME_FRAME_FAST_MS 33
+/* Default minimum splash time; SettingSplashMask picks one of GAME_SPLASH_STEPS */
+#define GAME_SPLASH_MS 2000
+#define GAME_SPLASH_STEPS 4
+/* A cast waits U[0, GAME_CAST_SPREAD_MS) + game_cast_base_ms(), at least GAME_TICK_MS */
+#define GAME_CAST_SPREAD_MS 4000
+/* OK presses this soon after a bite window closed do not dismiss LOST PKT */
+#define GAME_LOST_HOLD_MS 500
+/* game_timeout() when no timer is running */
+#define GAME_NO_DEADLINE UINT32_MAX
+
+typedef enum {
+    StateSplash, StateWaiting, StateFishing, StateBite, StateCaught,
+    StateLost, StateShop, StateSell, StateIndex,
+    StateWorldShop, StatePrestige, StateDevMenu, StatePerf, StateSettings, StateStats
+} FishingState;
+
+/* Mirrors InputKey / InputType so the core does not pull in input.h */
+typedef enum { GameKeyUp, GameKeyDown, GameKeyRight, GameKeyLeft, GameKeyOk, GameKeyBack } GameKey;
+typedef enum { GameInputShort, GameInputLong } GameInputType;
+
+typedef struct {
+    GameKey key;
+    GameInputType type;
+    /* Clock time the input was captured; never earlier than the previous step */
+    uint32_t time;
+} GameInput;
+
+/* Side effects requested by a step, carried out by the caller */
+typedef enum {
+    GameEffectNone = 0,
+    GameEffectSave = (1 << 0),
+    GameEffectExit = (1 << 1),
+    GameEffectBite = (1 << 2),
+    GameEffectCatch = (1 << 3),
+    GameEffectFail = (1 << 4),
+    GameEffectSuccess = (1 << 5),
+    GameEffectBlink = (1 << 6),
+    GameEffectRecord = (1 << 7), /* Toggle input recording */
+    GameEffectReplay = (1 << 8), /* Replay the last recording */
+    GameEffectPerfCsv = (1 << 9), /* Toggle perf CSV streaming */
+    GameEffectAchievement = (1 << 10), /* A rule unlocked; the bits are in progress.achievements */
+} GameEffect;
+
+#define DEV_MENU_ITEMS 7
+#define SETTINGS_ITEMS 4
+/* World rows on the catch stats screen */
+#define STATS_ROWS 3
+/* Rows per Net Index page; LEFT/RIGHT flip pages */
+#define INDEX_PAGE 7
+
+#define LEVEL_MAX 255
+
+/* Economy knobs; a host build can override them with -D for balance sweeps */
+#ifndef SHOP_BUFFER_COST
+#define SHOP_BUFFER_COST 50
+#endif
+#ifndef SHOP_ANTENNA_COST
+#define SHOP_ANTENNA_COST 80
+#endif
+#ifndef SHOP_LURE_COST
+#define SHOP_LURE_COST 60
+#endif
+/* Market bonus per core version above v1, in percent */
+#ifndef PRESTIGE_BONUS_PCT
+#define PRESTIGE_BONUS_PCT 25
+#endif
+#define CORE_VER_MAX 0xFFFF
+/* Distinct packet types the hold can carry at once */
+#define INV_SLOTS 24
+#define DISCOVERED_WORDS (CONTENT_MAX_PACKETS / 32)
+
+/* Bits of CyberFishProgress.settings */
+typedef enum {
+    SettingSmoothFx = (1 << 0), /* Fishing view at GAME_FRAME_FAST_MS */
+    SettingAutoTrawler = (1 << 1), /* Credit offline catches on load */
+    SettingSplashShift = 2,
+    SettingSplashMask = (3 << 2), /* Index into the minimum splash times */
+} GameSetting;
+
+typedef struct __attribute__((packed)) {
+    uint16_t pkt;
+    uint32_t count;
+} InvStack;
+
+/*
+ * Persistent progress. This packed record is also the save payload, so
+ * field order and widths are part of the file format: append new fields
+ * at the end, where old saves read back as zero.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t credits;
+    uint32_t high_score;
+    uint16_t core_ver;
+    uint8_t buffer_lvl;
+    uint8_t antenna_lvl;
+    uint8_t lure_lvl;
+    uint8_t current_world : 4;
+    uint8_t reserved : 4;
+    uint16_t world_unlocked; /* Bit per world */
+    uint8_t inv_used;
+    InvStack inv[INV_SLOTS]; /* Only the first inv_used stacks are live */
+    uint32_t discovered[DISCOVERED_WORDS]; /* Bit per packet type */
+    uint8_t settings; /* GameSetting bits; survive a reformat */
+    uint32_t saved_at; /* RTC timestamp, stamped into each save image */
+    AchievementState achievements; /* Survives a reformat */
+} CyberFishProgress;
+
+/* Per-session UI and timer state, never saved */
+typedef struct {
+    uint8_t current_state; /* FishingState */
+    uint8_t shop_cursor;
+    uint8_t dev_cursor;
+    uint8_t cheat_step;
+    uint16_t index_cursor;
+    uint16_t last_catch_idx;
+    uint16_t bite_pkt;
+    bool last_catch_sold; /* Hold was full, the catch went straight to the Market */
+    bool recording; /* Shell-owned status shown in the admin terminal */
+    uint16_t discovered_count;
+    uint8_t bite_tier;
+    /* Clock of the last step; drives animation as well as the timers */
+    uint32_t now_ms;
+    /* Splash end, bite or bite-window end, depending on current_state */
+    uint32_t deadline;
+    uint32_t bite_at;
+    uint32_t trawled; /* Packets the auto-trawler brought in, shown until the first input */
+    char dev_status[24];
+} CyberFishUi;
+
+typedef struct {
+    CyberFishProgress progress;
+    CyberFishUi ui;
+    uint32_t rng_state;
+    RarityTable rarity;
+    EntityPool fish; /* Part of the game state: a bite hooks one of them */
+} CyberFishApp;
+
+/* Memory budgets; growing past these should be a deliberate decision */
+_Static_assert(sizeof(CyberFishProgress) <= 224, "save record over budget");
+_Static_assert(sizeof(CyberFishUi) <= 56, "UI state over budget");
+_Static_assert(sizeof(CyberFishApp) <= 704, "app state over budget");
+_Static_assert(CONTENT_MAX_WORLDS <= 16, "world_unlocked is 16 bits");
+
+static inline bool game_discovered(const CyberFishApp* app, uint16_t pkt) {
+    return (app->progress.discovered[pkt >> 5] >> (pkt & 31)) & 1;
+}
+
+static inline bool game_world_unlocked(const CyberFishApp* app, int world) {
+    return (app->progress.world_unlocked >> world) & 1;
+}
+
+/* discovered_count is kept in step with the bitset, so this is O(1) */
+static inline bool game_index_complete(const CyberFishApp* app) {
+    return app->ui.discovered_count >= content_packet_count();
+}
+
+static inline const ContentWorld* game_world(const CyberFishApp* app) {
+    return content_world(app->progress.current_world);
+}
+
+extern const char* const prestige_icons[10];
+
+void reset_game(CyberFishApp* app);
+
+/*
+ * Market price of one packet: the base price plus PRESTIGE_BONUS_PCT per
+ * core version above v1, in integer math and saturated to UINT32_MAX.
+ */
+uint32_t game_price(uint16_t pkt, uint32_t core_ver);
+
+/* Adds to the balance, clamping at UINT32_MAX instead of wrapping */
+void game_add_credits(CyberFishApp* app, uint64_t amount);
+
+/*
+ * Adds count packets of one type to the hold and the Net Index. Whatever
+ * does not fit is sold on the spot.
+ */
+void game_add_packets(CyberFishApp* app, uint16_t pkt, uint32_t count);
+
+/* Fixed part of the wait after a cast, from the lure level and world depth */
+int32_t game_cast_base_ms(const CyberFishApp* app);
+
+/* Recounts discovered packets; call after loading or replacing progress */
+void game_sync_discovered(CyberFishApp* app);
+
+/*
+ * Zeroes app and marks the rarity table and the water as not built yet. A
+ * zeroed table would otherwise pass for one built at antenna 0, depth 0.
+ * Call once, before the first load or game_seed().
+ */
+void game_init(CyberFishApp* app);
+
+/*
+ * Puts a freshly loaded app on the splash screen, shown since clock time
+ * now. It stays up for at least game_splash_ms() from then.
+ */
+void game_start(CyberFishApp* app, uint32_t now);
+
+/* Rebuilds the rarity table if the antenna or world changed since it was built */
+void game_sync_rarity(CyberFishApp* app);
+
+/* Minimum splash time picked in the settings */
+uint32_t game_splash_ms(const CyberFishApp* app);
+
+/* Subscribes the achievement rules; call once, before the first game_step() */
+void game_events_init(void);
+
+/* All randomness comes from this seed, so equal seeds replay equal runs */
+void game_seed(CyberFishApp* app, uint32_t seed);
+
+/*
+ * Frame-rate policy: how often the current screen has to be stepped and
+ * redrawn, in ms. 0 means nothing on it changes until the next input.
+ */
+uint32_t game_frame_interval(const CyberFishApp* app);
+
+/* ms from now until the running timer fires, or GAME_NO_DEADLINE */
+uint32_t game_timeout(const CyberFishApp* app, uint32_t now);
+
+/*
+ * Advances the game to clock time now. Timers that expired up to
+ * input->time fire before the input is handled, the rest after it, so the
+ * outcome depends only on when inputs happened and not on how often the
+ * game was stepped in between. input is NULL on a timed wakeup. Returns a
+ * GameEffect mask.
+ */
+uint32_t game_step(CyberFishApp* app, const GameInput* input, uint32_t now);
@@ -0,0 +1,296 @@
+#include "cyber_fishing_history.h"
+#include "cyber_fishing_save.h"
+
+#include <storage/storage.h>
+#include <string.h>
+
+#define HISTORY_DIR EXT_PATH("apps_data")
+#define HISTORY_LOG_PATH EXT_PATH("apps_data/cyber_fishing.hist")
+#define HISTORY_TMP_PATH EXT_PATH("apps_data/cyber_fishing.hist.tmp")
+#define HISTORY_STATS_PATH EXT_PATH("apps_data/cyber_fishing.stats")
+#define HISTORY_STATS_TMP_PATH EXT_PATH("apps_data/cyber_fishing.stats.tmp")
+
+#define HISTORY_ENTRY_HEAD 2 /* Length byte, kind byte */
+#define HISTORY_STATS_HEADER 12
+
+/* Buffered byte stream over a log file, so entries are not read a few bytes at a time */
+typedef struct {
+    File* file;
+    uint8_t buf[256];
+    size_t len;
+    size_t pos;
+} HistoryStream;
+
+/* The compactor's working set; there is only ever one compactor */
+typedef struct {
+    HistoryStream in;
+    HistoryStream out;
+    HistoryAggregate aggs[CONTENT_MAX_WORLDS];
+    uint8_t entry[255];
+} HistoryScratch;
+
+static HistoryScratch scratch;
+
+static bool stream_read(HistoryStream* s, void* out, size_t n) {
+    uint8_t* dst = out;
+    while(n) {
+        if(s->pos == s->len) {
+            s->len = storage_file_read(s->file, s->buf, sizeof(s->buf));
+            s->pos = 0;
+            if(s->len == 0) return false;
+        }
+        size_t take = s->len - s->pos < n ? s->len - s->pos : n;
+        memcpy(dst, &s->buf[s->pos], take);
+        s->pos += take;
+        dst += take;
+        n -= take;
+    }
+    return true;
+}
+
+static bool stream_flush(HistoryStream* s) {
+    bool ok = s->len == 0 || storage_file_write(s->file, s->buf, s->len) == s->len;
+    s->len = 0;
+    return ok;
+}
+
+static bool stream_put(HistoryStream* s, uint8_t kind, const void* payload, uint8_t len) {
+    if(s->len + HISTORY_ENTRY_HEAD + len > sizeof(s->buf) && !stream_flush(s)) return false;
+    s->buf[s->len++] = len;
+    s->buf[s->len++] = kind;
+    memcpy(&s->buf[s->len], payload, len);
+    s->len += len;
+    return true;
+}
+
+static void history_save_stats(CatchHistory* hist) {
+    uint8_t image[HISTORY_STATS_HEADER + sizeof(HistoryStats)];
+    uint32_t magic = HISTORY_STATS_MAGIC;
+    uint16_t version = HISTORY_STATS_VERSION, len = sizeof(HistoryStats);
+    memcpy(image + HISTORY_STATS_HEADER, &hist->stats, len);
+    uint32_t crc = save_crc32(image + HISTORY_STATS_HEADER, len);
+    memcpy(image, &magic, 4);
+    memcpy(image + 4, &version, 2);
+    memcpy(image + 6, &len, 2);
+    memcpy(image + 8, &crc, 4);
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    storage_common_mkdir(storage, HISTORY_DIR);
+    File* file = storage_file_alloc(storage);
+    /* Written aside and renamed over, like the save, so a torn write never costs the old counters */
+    bool ok = storage_file_open(file, HISTORY_STATS_TMP_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS) &&
+              storage_file_write(file, image, sizeof(image)) == sizeof(image);
+    storage_file_close(file);
+    storage_file_free(file);
+    if(ok && save_replace_file(storage, HISTORY_STATS_TMP_PATH, HISTORY_STATS_PATH)) hist->stats_dirty = false;
+    furi_record_close(RECORD_STORAGE);
+}
+
+static bool history_read_stats(Storage* storage, const char* path, HistoryStats* stats) {
+    uint8_t image[HISTORY_STATS_HEADER + sizeof(HistoryStats)];
+    File* file = storage_file_alloc(storage);
+    size_t len = 0;
+    if(storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        len = storage_file_read(file, image, sizeof(image));
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+
+    uint32_t magic, crc;
+    uint16_t version, payload;
+    if(len != sizeof(image)) return false;
+    memcpy(&magic, image, 4);
+    memcpy(&version, image + 4, 2);
+    memcpy(&payload, image + 6, 2);
+    memcpy(&crc, image + 8, 4);
+    if(magic != HISTORY_STATS_MAGIC || version != HISTORY_STATS_VERSION || payload != sizeof(HistoryStats)) return false;
+    if(save_crc32(image + HISTORY_STATS_HEADER, payload) != crc) return false;
+    memcpy(stats, image + HISTORY_STATS_HEADER, payload);
+    return true;
+}
+
+void history_init(CatchHistory* hist) {
+    memset(hist, 0, sizeof(CatchHistory));
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    /* A valid temp file means we died between removing the old counters and the rename */
+    if(!history_read_stats(storage, HISTORY_STATS_PATH, &hist->stats)) {
+        history_read_stats(storage, HISTORY_STATS_TMP_PATH, &hist->stats);
+    }
+    furi_record_close(RECORD_STORAGE);
+}
+
+void history_bite(CatchHistory* hist, uint8_t world) {
+    if(world >= CONTENT_MAX_WORLDS) return;
+    hist->stats.bites[world]++;
+    hist->stats_dirty = true;
+}
+
+void history_add(CatchHistory* hist, const HistoryCatch* rec, uint32_t now) {
+    HistoryStats* stats = &hist->stats;
+    if(rec->world < CONTENT_MAX_WORLDS) stats->catches[rec->world]++;
+    uint32_t bucket = rec->reaction_ms / HISTORY_REACTION_STEP_MS;
+    stats->reaction_hist[bucket < HISTORY_REACTION_BUCKETS ? bucket : HISTORY_REACTION_BUCKETS - 1]++;
+    stats->reaction_sum_ms += rec->reaction_ms;
+    stats->value += rec->price;
+    stats->total++;
+    if(hist->last_catch && now - hist->last_catch < HISTORY_IDLE_CAP_MS) stats->active_ms += now - hist->last_catch;
+    hist->last_catch = now ? now : 1;
+    hist->stats_dirty = true;
+
+    if(hist->head - hist->tail >= HISTORY_RING) {
+        /* Only reachable while the log cannot be written; keep the newest */
+        hist->tail++;
+        hist->dropped++;
+    }
+    hist->ring[hist->head & (HISTORY_RING - 1)] = *rec;
+    hist->head++;
+}
+
+/* Appends everything queued in one write, then the counters that now match it */
+static void history_write_batch(CatchHistory* hist) {
+    uint32_t queued = hist->head - hist->tail;
+    if(queued) {
+        static HistoryStream out;
+        Storage* storage = furi_record_open(RECORD_STORAGE);
+        storage_common_mkdir(storage, HISTORY_DIR);
+        out.file = storage_file_alloc(storage);
+        out.len = 0;
+        bool ok = storage_file_open(out.file, HISTORY_LOG_PATH, FSAM_WRITE, FSOM_OPEN_APPEND);
+        for(uint32_t i = hist->tail; ok && i != hist->head; i++) {
+            ok = stream_put(&out, HistoryKindCatch, &hist->ring[i & (HISTORY_RING - 1)], sizeof(HistoryCatch));
+        }
+        ok = ok && stream_flush(&out);
+        storage_file_close(out.file);
+        storage_file_free(out.file);
+        furi_record_close(RECORD_STORAGE);
+        /* On failure the batch stays queued and the next poll retries */
+        if(!ok) return;
+        hist->tail = hist->head;
+        hist->stats.log_catches += queued;
+    }
+    if(hist->stats_dirty) history_save_stats(hist);
+}
+
+static void history_fold(HistoryAggregate* agg, const HistoryCatch* rec) {
+    if(agg->catches == 0 || rec->time < agg->first_time) agg->first_time = rec->time;
+    if(rec->time > agg->last_time) agg->last_time = rec->time;
+    agg->catches++;
+    agg->value += rec->price;
+    agg->reaction_sum_ms += rec->reaction_ms;
+}
+
+static void history_merge(HistoryAggregate* agg, const HistoryAggregate* old) {
+    if(old->catches == 0) return;
+    if(agg->catches == 0 || old->first_time < agg->first_time) agg->first_time = old->first_time;
+    if(old->last_time > agg->last_time) agg->last_time = old->last_time;
+    agg->catches += old->catches;
+    agg->value += old->value;
+    agg->reaction_sum_ms += old->reaction_sum_ms;
+}
+
+/*
+ * Rewrites the log with the oldest catches folded into the per-world
+ * aggregates. The main loop holds new catches in the ring until this
+ * finishes, so the log is never written from two threads.
+ */
+static int32_t history_compact_worker(void* ctx) {
+    CatchHistory* hist = ctx;
+    HistoryScratch* s = &scratch;
+    uint32_t fold = hist->stats.log_catches > HISTORY_LOG_KEEP ? hist->stats.log_catches - HISTORY_LOG_KEEP : 0;
+    uint32_t seen = 0, kept = 0;
+    memset(s->aggs, 0, sizeof(s->aggs));
+    for(int w=0; w<CONTENT_MAX_WORLDS; w++) s->aggs[w].world = w;
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    s->in.file = storage_file_alloc(storage);
+    s->out.file = storage_file_alloc(storage);
+    s->in.len = s->in.pos = s->out.len = 0;
+    bool ok = storage_file_open(s->in.file, HISTORY_LOG_PATH, FSAM_READ, FSOM_OPEN_EXISTING) &&
+              storage_file_open(s->out.file, HISTORY_TMP_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS);
+    uint8_t head[HISTORY_ENTRY_HEAD];
+    while(ok && stream_read(&s->in, head, sizeof(head))) {
+        uint8_t len = head[0], kind = head[1];
+        /* A torn tail ends the log */
+        if(!stream_read(&s->in, s->entry, len)) break;
+        if(kind == HistoryKindCatch && len == sizeof(HistoryCatch)) {
+            HistoryCatch rec;
+            memcpy(&rec, s->entry, sizeof(rec));
+            if(seen++ < fold && rec.world < CONTENT_MAX_WORLDS) {
+                history_fold(&s->aggs[rec.world], &rec);
+            } else {
+                ok = stream_put(&s->out, kind, s->entry, len);
+                kept++;
+            }
+        } else if(kind == HistoryKindAggregate && len == sizeof(HistoryAggregate)) {
+            HistoryAggregate old;
+            memcpy(&old, s->entry, sizeof(old));
+            if(old.world < CONTENT_MAX_WORLDS) history_merge(&s->aggs[old.world], &old);
+        } else {
+            ok = stream_put(&s->out, kind, s->entry, len);
+        }
+    }
+    for(int w=0; ok && w<CONTENT_MAX_WORLDS; w++) {
+        if(s->aggs[w].catches) ok = stream_put(&s->out, HistoryKindAggregate, &s->aggs[w], sizeof(HistoryAggregate));
+    }
+    ok = ok && stream_flush(&s->out);
+    storage_file_close(s->in.file);
+    storage_file_close(s->out.file);
+    storage_file_free(s->in.file);
+    storage_file_free(s->out.file);
+    ok = ok && save_replace_file(storage, HISTORY_TMP_PATH, HISTORY_LOG_PATH);
+    if(!ok) storage_common_remove(storage, HISTORY_TMP_PATH);
+    furi_record_close(RECORD_STORAGE);
+    hist->compact_kept = kept;
+    hist->compact_ok = ok;
+    return 0;
+}
+
+static void history_reap(CatchHistory* hist) {
+    furi_thread_join(hist->compactor);
+    furi_thread_free(hist->compactor);
+    hist->compactor = NULL;
+    /* On failure the log is as it was, so the count stands and the next poll retries */
+    if(hist->compact_ok) {
+        hist->stats.log_catches = hist->compact_kept;
+        hist->stats_dirty = true;
+    }
+}
+
+void history_poll(CatchHistory* hist) {
+    if(hist->compactor) {
+        if(furi_thread_get_state(hist->compactor) != FuriThreadStateStopped) return;
+        history_reap(hist);
+        history_write_batch(hist);
+    }
+    if(hist->head - hist->tail >= HISTORY_BATCH) history_write_batch(hist);
+    if(hist->stats.log_catches >= HISTORY_LOG_MAX) {
+        hist->compact_ok = false;
+        hist->compactor = furi_thread_alloc_ex("CyberFishHist", 2048, history_compact_worker, hist);
+        furi_thread_start(hist->compactor);
+    }
+}
+
+void history_close(CatchHistory* hist) {
+    if(hist->compactor) history_reap(hist);
+    history_write_batch(hist);
+}
+
+uint32_t history_reaction_mean(const HistoryStats* stats) {
+    return stats->total ? (uint32_t)(stats->reaction_sum_ms / stats->total) : 0;
+}
+
+uint32_t history_reaction_p95(const HistoryStats* stats) {
+    if(stats->total == 0) return 0;
+    uint64_t target = ((uint64_t)stats->total * 95 + 99) / 100;
+    uint64_t seen = 0;
+    for(int b=0; b<HISTORY_REACTION_BUCKETS; b++) {
+        seen += stats->reaction_hist[b];
+        if(seen >= target) return (b + 1) * HISTORY_REACTION_STEP_MS;
+    }
+    return HISTORY_REACTION_BUCKETS * HISTORY_REACTION_STEP_MS;
+}
+
+uint32_t history_credits_per_min(const HistoryStats* stats) {
+    if(stats->active_ms == 0) return 0;
+    uint64_t rate = stats->value * 60000 / stats->active_ms;
+    return rate > UINT32_MAX ? UINT32_MAX : (uint32_t)rate;
+}
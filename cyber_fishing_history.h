@@ -0,0 +1,103 @@
+#pragma once
+
+#include <furi.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "cyber_fishing_content.h"
+
+/*
+ * Catch history. Each catch goes into a RAM ring and is appended to
+ * apps_data/cyber_fishing.hist in batches. Every log entry starts with a
+ * length byte and a kind byte, so readers can skip kinds they don't know.
+ *
+ * Statistics are running counters, updated as catches come in and saved
+ * next to the log. The stats screen never reads the log back. Once the log
+ * holds HISTORY_LOG_MAX catches, a worker thread compacts it: all but the
+ * newest HISTORY_LOG_KEEP catches are folded into one aggregate entry per
+ * world. The log never grows past CONTENT_MAX_WORLDS aggregates plus
+ * HISTORY_LOG_MAX + HISTORY_RING catches.
+ */
+
+#define HISTORY_RING 16 /* Power of two */
+#define HISTORY_BATCH 8
+#define HISTORY_LOG_MAX 4096
+#define HISTORY_LOG_KEEP 1024
+/* Reaction-time histogram for the p95; the last bucket is open-ended */
+#define HISTORY_REACTION_BUCKETS 32
+#define HISTORY_REACTION_STEP_MS 64
+/* Longer gaps between catches count as idle, not as fishing time */
+#define HISTORY_IDLE_CAP_MS 60000
+
+#define HISTORY_STATS_MAGIC 0x54534643u /* "CFST" */
+#define HISTORY_STATS_VERSION 1
+
+typedef enum {
+    HistoryKindCatch = 1,
+    HistoryKindAggregate = 2,
+} HistoryKind;
+
+typedef struct __attribute__((packed)) {
+    uint32_t time; /* RTC timestamp */
+    uint16_t pkt;
+    uint8_t world;
+    uint8_t tier;
+    uint16_t reaction_ms; /* Bite to OK press, saturated */
+    uint32_t price; /* Market price when caught */
+} HistoryCatch;
+
+typedef struct __attribute__((packed)) {
+    uint32_t first_time;
+    uint32_t last_time;
+    uint32_t catches;
+    uint64_t value;
+    uint64_t reaction_sum_ms;
+    uint8_t world;
+} HistoryAggregate;
+
+/* Running totals; this struct is the stats file payload */
+typedef struct {
+    uint32_t bites[CONTENT_MAX_WORLDS];
+    uint32_t catches[CONTENT_MAX_WORLDS];
+    uint32_t reaction_hist[HISTORY_REACTION_BUCKETS];
+    uint64_t value;
+    uint64_t reaction_sum_ms;
+    uint32_t total;
+    uint32_t active_ms;
+    uint32_t log_catches; /* Catch entries in the log, not yet folded */
+} HistoryStats;
+
+typedef struct {
+    HistoryStats stats;
+    HistoryCatch ring[HISTORY_RING];
+    uint32_t head;
+    uint32_t tail;
+    uint32_t dropped;
+    uint32_t last_catch; /* furi_get_tick() of the previous catch this session */
+    bool stats_dirty;
+    FuriThread* compactor;
+    /* Written by the compactor before it exits, read after the join */
+    bool compact_ok;
+    uint32_t compact_kept;
+} CatchHistory;
+
+/* Loads the saved counters; a missing or torn stats file starts from zero */
+void history_init(CatchHistory* hist);
+
+void history_bite(CatchHistory* hist, uint8_t world);
+
+/* Counts a catch and queues it for the log. now is furi_get_tick(). */
+void history_add(CatchHistory* hist, const HistoryCatch* rec, uint32_t now);
+
+/* Writes full batches, and starts or reaps a compaction. Call once per loop. */
+void history_poll(CatchHistory* hist);
+
+/* Waits for a running compaction and writes everything still queued */
+void history_close(CatchHistory* hist);
+
+uint32_t history_reaction_mean(const HistoryStats* stats);
+
+/* Upper edge of the bucket holding the 95th percentile, in ms */
+uint32_t history_reaction_p95(const HistoryStats* stats);
+
+uint32_t history_credits_per_min(const HistoryStats* stats);
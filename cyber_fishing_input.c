@@ -0,0 +1,46 @@
+#include "cyber_fishing_input.h"
+
+#include <string.h>
+
+void input_ring_init(InputRing* ring) {
+    memset(ring, 0, sizeof(InputRing));
+    ring->consumer = furi_thread_get_current_id();
+}
+
+void input_ring_push(InputRing* ring, const InputEvent* event) {
+    if(event->type != InputTypeShort && event->type != InputTypeLong) return;
+    uint32_t head = ring->head;
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    if(head - tail >= INPUT_RING_SIZE) {
+        ring->dropped++;
+        return;
+    }
+    StampedInput* slot = &ring->slots[head & (INPUT_RING_SIZE - 1)];
+    slot->time = furi_get_tick();
+    slot->key = event->key;
+    slot->type = event->type;
+    /* Publish the slot before the consumer can see the new head */
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+    ring->pushed++;
+    furi_thread_flags_set(ring->consumer, INPUT_RING_FLAG);
+}
+
+bool input_ring_pop(InputRing* ring, StampedInput* out) {
+    uint32_t tail = ring->tail;
+    if(__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) == tail) return false;
+    *out = ring->slots[tail & (INPUT_RING_SIZE - 1)];
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+uint32_t input_ring_count(const InputRing* ring) {
+    return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - ring->tail;
+}
+
+bool input_ring_wait(InputRing* ring, uint32_t timeout) {
+    /* Clear first so a flag left over from an already drained push cannot wake us */
+    furi_thread_flags_clear(INPUT_RING_FLAG);
+    if(input_ring_count(ring)) return true;
+    uint32_t flags = furi_thread_flags_wait(INPUT_RING_FLAG, FuriFlagWaitAny, timeout);
+    return !(flags & FuriFlagError);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <furi.h>
+#include <input/input.h>
+
+/*
+ * Input path from the input service thread to the main loop. The callback
+ * must never block, so instead of a message queue it pushes into a
+ * single-producer/single-consumer ring and wakes the main loop with a
+ * thread flag.
+ *
+ * Events are stamped with furi_get_tick() when they are captured, so the
+ * game can judge a press by when it happened rather than when the main
+ * loop got around to it.
+ *
+ * Policy:
+ *  - Press, release and repeat events are coalesced away at the producer;
+ *    the game only consumes the short/long event each gesture ends in.
+ *  - When the ring is full the new event is dropped and counted. The ring
+ *    holds more gestures than a player can make during a save flush.
+ */
+
+#define INPUT_RING_SIZE 16 /* Power of two */
+#define INPUT_RING_FLAG (1u << 0)
+
+typedef struct {
+    uint32_t time; /* furi_get_tick() at capture */
+    uint8_t key; /* InputKey */
+    uint8_t type; /* InputType */
+} StampedInput;
+
+typedef struct {
+    StampedInput slots[INPUT_RING_SIZE];
+    uint32_t head; /* Written by the producer only */
+    uint32_t tail; /* Written by the consumer only */
+    uint32_t pushed;
+    uint32_t dropped;
+    FuriThreadId consumer;
+} InputRing;
+
+/* Must be called from the thread that will pop */
+void input_ring_init(InputRing* ring);
+
+/* Producer side, safe to call from the input callback */
+void input_ring_push(InputRing* ring, const InputEvent* event);
+
+/* Consumer side */
+bool input_ring_pop(InputRing* ring, StampedInput* out);
+uint32_t input_ring_count(const InputRing* ring);
+
+/*
+ * Sleeps until an event is pushed or timeout expires. Returns false on
+ * timeout. Returns at once if events are already waiting.
+ */
+bool input_ring_wait(InputRing* ring, uint32_t timeout);
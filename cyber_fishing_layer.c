@@ -0,0 +1,125 @@
+#include "cyber_fishing_layer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define LAYER_STRIDE (LAYER_W / 8)
+
+static void layer_dot(uint8_t* bits, int x, int y) {
+    if(x < 0 || y < 0 || x >= LAYER_W || y >= LAYER_H) return;
+    bits[y * LAYER_STRIDE + (x >> 3)] |= (1 << (x & 7));
+}
+
+static void layer_line(uint8_t* bits, int x1, int y1, int x2, int y2) {
+    int dx = abs(x2 - x1);
+    int dy = abs(y2 - y1);
+    bool swapxy = dy > dx;
+    int t;
+    if(swapxy) {
+        t = x1; x1 = y1; y1 = t;
+        t = x2; x2 = y2; y2 = t;
+        t = dx; dx = dy; dy = t;
+    }
+    if(x1 > x2) {
+        t = x1; x1 = x2; x2 = t;
+        t = y1; y1 = y2; y2 = t;
+    }
+    int err = dx >> 1;
+    int ystep = (y2 > y1) ? 1 : -1;
+    int y = y1;
+    for(int x = x1; x <= x2; x++) {
+        if(swapxy) layer_dot(bits, y, x);
+        else layer_dot(bits, x, y);
+        err -= dy;
+        if(err < 0) {
+            y += ystep;
+            err += dx;
+        }
+    }
+}
+
+static void layer_frame(uint8_t* bits, int x, int y, int w, int h) {
+    layer_line(bits, x, y, x + w - 1, y);
+    layer_line(bits, x, y + h - 1, x + w - 1, y + h - 1);
+    layer_line(bits, x, y, x, y + h - 1);
+    layer_line(bits, x + w - 1, y, x + w - 1, y + h - 1);
+}
+
+static void layer_circle(uint8_t* bits, int x0, int y0, int rad) {
+    int f = 1 - rad;
+    int ddf_x = 1;
+    int ddf_y = -2 * rad;
+    int x = 0;
+    int y = rad;
+    for(;;) {
+        layer_dot(bits, x0 + x, y0 - y); layer_dot(bits, x0 + y, y0 - x);
+        layer_dot(bits, x0 - x, y0 - y); layer_dot(bits, x0 - y, y0 - x);
+        layer_dot(bits, x0 + x, y0 + y); layer_dot(bits, x0 + y, y0 + x);
+        layer_dot(bits, x0 - x, y0 + y); layer_dot(bits, x0 - y, y0 + x);
+        if(x >= y) break;
+        if(f >= 0) {
+            y--;
+            ddf_y += 2;
+            f += ddf_y;
+        }
+        x++;
+        ddf_x += 2;
+        f += ddf_x;
+    }
+}
+
+static void layer_draw_world(uint8_t* bits, int world) {
+    /* The fisher stands on the dock in every world */
+    layer_circle(bits, 45, 35, 3);
+    layer_line(bits, 45, 38, 45, 43);
+    layer_line(bits, 0, 45, 55, 45);
+    if(world == 0) {
+        layer_line(bits, 10, 45, 10, 60);
+        layer_line(bits, 40, 45, 40, 60);
+    } else if(world == 1) {
+        for(int i=0; i<60; i+=15) {
+            layer_line(bits, i, 45, i+5, 20);
+            layer_line(bits, i+5, 20, i+10, 45);
+        }
+    } else if(world == 2) {
+        layer_frame(bits, 5, 20, 10, 25);
+        layer_frame(bits, 25, 10, 15, 35);
+    } else if(world == 3) {
+        for(int i=0; i<15; i++) layer_dot(bits, (i*17)%128, (i*9)%45);
+    }
+}
+
+/* Shrinks the bitmap in place to the byte-aligned box around its set pixels */
+static void layer_crop(WorldLayer* layer) {
+    int min_col = LAYER_STRIDE, max_col = -1, min_row = LAYER_H, max_row = -1;
+    for(int row = 0; row < LAYER_H; row++) {
+        for(int col = 0; col < LAYER_STRIDE; col++) {
+            if(!layer->bits[row * LAYER_STRIDE + col]) continue;
+            if(col < min_col) min_col = col;
+            if(col > max_col) max_col = col;
+            if(row < min_row) min_row = row;
+            if(row > max_row) max_row = row;
+        }
+    }
+    if(max_row < 0) {
+        layer->x = layer->y = layer->w = layer->h = 0;
+        return;
+    }
+    int stride = max_col - min_col + 1;
+    /* Every destination byte precedes its source, so rows can move front to back */
+    for(int row = min_row; row <= max_row; row++) {
+        memmove(&layer->bits[(row - min_row) * stride], &layer->bits[row * LAYER_STRIDE + min_col], stride);
+    }
+    layer->x = min_col * 8;
+    layer->y = min_row;
+    layer->w = stride * 8;
+    layer->h = max_row - min_row + 1;
+}
+
+void world_layer_prepare(WorldLayer* layer, int world) {
+    if(layer->world == world) return;
+    memset(layer->bits, 0, sizeof(layer->bits));
+    layer_draw_world(layer->bits, world);
+    layer_crop(layer);
+    layer->world = world;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Pre-rendered static scenery. The parts of each world background that never
+ * move (dock posts, trees, buildings, stars, the fisher) are rasterized once
+ * into a 1-bit XBM and blitted with a single canvas_draw_xbm per frame.
+ * The rasterizer follows u8g2's line and circle algorithms so the cached
+ * layer is pixel-identical to drawing the primitives directly.
+ */
+
+#define LAYER_W 128
+#define LAYER_H 64
+
+typedef struct {
+    int world; /* -1 until built */
+    uint8_t x, y, w, h; /* Crop of the bitmap on screen, x and w byte aligned */
+    uint8_t bits[LAYER_W / 8 * LAYER_H];
+} WorldLayer;
+
+/* Rebuilds the layer if it does not hold the given world yet */
+void world_layer_prepare(WorldLayer* layer, int world);
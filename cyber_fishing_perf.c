@@ -0,0 +1,79 @@
+#include "cyber_fishing_perf.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define PERF_CSV_PATH EXT_PATH("apps_data/cyber_fishing_perf.csv")
+
+void perf_end(PerfStats* perf, PerfProbe probe, uint32_t start) {
+    uint32_t us = (DWT->CYCCNT - start) / furi_hal_cortex_instructions_per_microsecond();
+    PerfTiming* t = &perf->probes[probe];
+    t->last_us = us;
+    if(us > t->max_us) t->max_us = us;
+    t->avg_us = t->count ? t->avg_us - (t->avg_us >> 3) + (us >> 3) : us;
+    t->count++;
+}
+
+void perf_loop_wait(PerfStats* perf, uint32_t timeout, uint32_t waited, bool timed_out, uint32_t period, uint32_t frame_ms) {
+    perf->wakeups++;
+    if(timed_out && timeout != FuriWaitForever) {
+        perf->jitter_ms = (int32_t)(waited - timeout);
+        uint32_t late = perf->jitter_ms > 0 ? (uint32_t)perf->jitter_ms : 0;
+        if(late > perf->jitter_max_ms) perf->jitter_max_ms = late;
+    }
+    if(frame_ms && period > frame_ms * 2) perf->dropped_frames += period / frame_ms - 1;
+}
+
+void perf_input_lag(PerfStats* perf, uint32_t lag_ms) {
+    perf->input_lag_ms = lag_ms;
+    if(lag_ms > perf->input_lag_max_ms) perf->input_lag_max_ms = lag_ms;
+}
+
+bool perf_csv_start(PerfStats* perf) {
+    if(perf->csv) return true;
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    storage_common_mkdir(storage, EXT_PATH("apps_data"));
+    perf->csv = storage_file_alloc(storage);
+    if(!storage_file_open(perf->csv, PERF_CSV_PATH, FSAM_WRITE, FSOM_OPEN_APPEND)) {
+        storage_file_free(perf->csv);
+        perf->csv = NULL;
+        furi_record_close(RECORD_STORAGE);
+        return false;
+    }
+    if(storage_file_size(perf->csv) == 0) {
+        const char* header = "ms,render_us,render_max,bg_us,bg_max,save_us,save_max,load_us,"
+                             "jitter_ms,jitter_max,queue_hw,dropped,wakeups,redraws,input_lag,input_lag_max,input_dropped\n";
+        storage_file_write(perf->csv, header, strlen(header));
+    }
+    perf->csv_last_ms = 0;
+    return true;
+}
+
+void perf_csv_stop(PerfStats* perf) {
+    if(!perf->csv) return;
+    storage_file_close(perf->csv);
+    storage_file_free(perf->csv);
+    furi_record_close(RECORD_STORAGE);
+    perf->csv = NULL;
+}
+
+uint32_t perf_csv_wait(const PerfStats* perf, uint32_t now) {
+    if(!perf->csv) return FuriWaitForever;
+    uint32_t since = now - perf->csv_last_ms;
+    return since < PERF_CSV_PERIOD_MS ? PERF_CSV_PERIOD_MS - since : 0;
+}
+
+void perf_csv_poll(PerfStats* perf, uint32_t now) {
+    if(!perf->csv || now - perf->csv_last_ms < PERF_CSV_PERIOD_MS) return;
+    perf->csv_last_ms = now;
+    const PerfTiming* p = perf->probes;
+    char line[192];
+    int len = snprintf(
+        line, sizeof(line), "%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%ld,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu\n",
+        now, p[PerfProbeRender].avg_us, p[PerfProbeRender].max_us, p[PerfProbeWorldBg].avg_us,
+        p[PerfProbeWorldBg].max_us, p[PerfProbeSave].last_us, p[PerfProbeSave].max_us,
+        p[PerfProbeLoad].last_us, perf->jitter_ms, perf->jitter_max_ms, perf->queue_high_water,
+        perf->dropped_frames, perf->wakeups, perf->redraws, perf->input_lag_ms, perf->input_lag_max_ms,
+        perf->input_dropped);
+    if(len > 0) storage_file_write(perf->csv, line, (size_t)len < sizeof(line) ? (size_t)len : sizeof(line) - 1);
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <furi.h>
+#include <furi_hal.h>
+#include <storage/storage.h>
+
+/*
+ * Hot-path instrumentation for the admin terminal's perf page. Probes are
+ * timed with the DWT cycle counter; loop health is tracked against the
+ * frame interval the main loop asked to sleep for.
+ */
+
+typedef enum {
+    PerfProbeRender,
+    PerfProbeWorldBg,
+    PerfProbeSave,
+    PerfProbeLoad,
+    PerfProbeCount,
+} PerfProbe;
+
+typedef struct {
+    uint32_t last_us;
+    uint32_t max_us;
+    uint32_t avg_us; /* Exponential moving average, 1/8 weight */
+    uint32_t count;
+} PerfTiming;
+
+typedef struct {
+    PerfTiming probes[PerfProbeCount];
+    /* How late a timed-out wait returned, against the requested timeout */
+    int32_t jitter_ms;
+    uint32_t jitter_max_ms;
+    uint32_t queue_depth;
+    uint32_t queue_high_water;
+    /* Capture-to-step latency of the last input, and inputs the ring dropped */
+    uint32_t input_lag_ms;
+    uint32_t input_lag_max_ms;
+    uint32_t input_dropped;
+    /* Frame intervals skipped because an iteration overran */
+    uint32_t dropped_frames;
+    uint32_t wakeups;
+    uint32_t redraws;
+    /* From app entry to leaving the splash, and whether that happened yet */
+    uint32_t launch_ms;
+    bool launched;
+    File* csv;
+    uint32_t csv_last_ms;
+} PerfStats;
+
+#define PERF_CSV_PERIOD_MS 1000
+
+static inline uint32_t perf_begin(void) {
+    return DWT->CYCCNT;
+}
+
+void perf_end(PerfStats* perf, PerfProbe probe, uint32_t start);
+
+/*
+ * Called after each queue wait with the timeout asked for, how long the
+ * wait took, and the time since the previous wakeup.
+ */
+void perf_loop_wait(PerfStats* perf, uint32_t timeout, uint32_t waited, bool timed_out, uint32_t period, uint32_t frame_ms);
+
+void perf_input_lag(PerfStats* perf, uint32_t lag_ms);
+
+bool perf_csv_start(PerfStats* perf);
+void perf_csv_stop(PerfStats* perf);
+
+/* Appends a CSV row if streaming and a period has passed */
+void perf_csv_poll(PerfStats* perf, uint32_t now);
+
+/* ms until the next CSV row is due, or FuriWaitForever when not streaming */
+uint32_t perf_csv_wait(const PerfStats* perf, uint32_t now);
@@ -0,0 +1,24 @@
+#include "cyber_fishing_rarity.h"
+
+/* A roll strictly above threshold[i] reaches tier i+1 */
+static const uint32_t rarity_thresholds[RARITY_TIERS - 1] = {40, 70, 90, 120, 150, 180};
+
+int rarity_tier_for_roll(uint32_t r) {
+    int tier = 0;
+    while(tier < RARITY_TIERS - 1 && r > rarity_thresholds[tier]) tier++;
+    return tier;
+}
+
+void rarity_table_build(RarityTable* table, uint32_t antenna_lvl, int world) {
+    uint64_t offset = (uint64_t)antenna_lvl * 4 + (uint64_t)world * 20;
+    /* Anything past the top threshold is the top tier anyway */
+    if(offset > rarity_thresholds[RARITY_TIERS - 2] + 1) offset = rarity_thresholds[RARITY_TIERS - 2] + 1;
+    table->antenna_lvl = antenna_lvl;
+    table->world = world;
+    for(int i=0; i<RARITY_TIERS; i++) table->weight[i] = 0;
+    for(uint32_t u = 0; u < RARITY_ROLLS; u++) {
+        int tier = rarity_tier_for_roll(u + (uint32_t)offset);
+        table->tier_of[u] = tier;
+        table->weight[tier]++;
+    }
+}
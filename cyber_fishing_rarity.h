@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Seedable PRNG and rarity sampling. A bite rolls r = U[0,100) +
+ * antenna_lvl * 4 + current_world * 20 and maps r through the rarity
+ * thresholds. Since only U is random, the outcome for every possible roll
+ * is tabulated once per (antenna, world) and a bite becomes one lookup.
+ */
+
+#define RARITY_TIERS 7
+#define RARITY_ROLLS 100
+
+typedef struct {
+    uint32_t antenna_lvl;
+    int world;
+    /* Rolls out of RARITY_ROLLS landing on each tier */
+    uint8_t weight[RARITY_TIERS];
+    uint8_t tier_of[RARITY_ROLLS];
+} RarityTable;
+
+/* xorshift32; state must never be 0 */
+static inline uint32_t rng_next(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/* Uniform value in [0, n) using a multiply-shift instead of a modulo */
+static inline uint32_t rng_range(uint32_t* state, uint32_t n) {
+    return (uint32_t)(((uint64_t)rng_next(state) * n) >> 32);
+}
+
+static inline uint32_t rng_seed_state(uint32_t seed) {
+    return seed ? seed : 0x9E3779B9u;
+}
+
+/* Rarity tier for a raw roll, as in the original nested comparison */
+int rarity_tier_for_roll(uint32_t r);
+
+void rarity_table_build(RarityTable* table, uint32_t antenna_lvl, int world);
+
+static inline int rarity_sample(const RarityTable* table, uint32_t* rng) {
+    return table->tier_of[rng_range(rng, RARITY_ROLLS)];
+}
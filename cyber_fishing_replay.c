@@ -0,0 +1,158 @@
+#include "cyber_fishing_replay.h"
+#include "cyber_fishing_save.h"
+
+#include <furi.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REPLAY_PATH EXT_PATH("apps_data/cyber_fishing.rec")
+
+#define REPLAY_CODE_END 0xFE
+#define REPLAY_CODE_GAP 0xFF
+#define REPLAY_RECORD_SIZE 3
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t app_size;
+} ReplayHeader;
+
+static void replay_digest(ReplayDigest* digest, const CyberFishApp* app) {
+    uint8_t image[SAVE_IMAGE_MAX];
+    size_t len = save_encode(app, image);
+    digest->time = app->ui.now_ms;
+    digest->rng_state = app->rng_state;
+    digest->state = app->ui.current_state;
+    digest->save_crc = save_crc32(image, len);
+}
+
+void replay_recorder_init(ReplayRecorder* rec) {
+    memset(rec, 0, sizeof(ReplayRecorder));
+}
+
+static void replay_flush_buf(ReplayRecorder* rec) {
+    if(rec->buf_len) storage_file_write(rec->file, rec->buf, rec->buf_len);
+    rec->buf_len = 0;
+}
+
+static void replay_put(ReplayRecorder* rec, uint32_t delta, uint8_t code) {
+    if((size_t)rec->buf_len + REPLAY_RECORD_SIZE > sizeof(rec->buf)) replay_flush_buf(rec);
+    rec->buf[rec->buf_len++] = delta & 0xFF;
+    rec->buf[rec->buf_len++] = (delta >> 8) & 0xFF;
+    rec->buf[rec->buf_len++] = code;
+}
+
+/* Emits gap records until the remaining delta fits in 16 bits */
+static uint32_t replay_put_gaps(ReplayRecorder* rec, uint32_t delta) {
+    while(delta > 0xFFFF) {
+        replay_put(rec, 0xFFFF, REPLAY_CODE_GAP);
+        delta -= 0xFFFF;
+    }
+    return delta;
+}
+
+bool replay_record_start(ReplayRecorder* rec, const CyberFishApp* app) {
+    if(rec->active) return true;
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    storage_common_mkdir(storage, EXT_PATH("apps_data"));
+    rec->file = storage_file_alloc(storage);
+    if(!storage_file_open(rec->file, REPLAY_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
+        storage_file_free(rec->file);
+        rec->file = NULL;
+        furi_record_close(RECORD_STORAGE);
+        return false;
+    }
+    ReplayHeader header = {.magic = REPLAY_MAGIC, .version = REPLAY_VERSION, .app_size = sizeof(CyberFishApp)};
+    storage_file_write(rec->file, &header, sizeof(header));
+    storage_file_write(rec->file, app, sizeof(CyberFishApp));
+    rec->last_time = app->ui.now_ms;
+    rec->events = 0;
+    rec->buf_len = 0;
+    rec->active = true;
+    return true;
+}
+
+void replay_record_input(ReplayRecorder* rec, const GameInput* input) {
+    if(!rec->active) return;
+    uint32_t delta = replay_put_gaps(rec, input->time - rec->last_time);
+    replay_put(rec, delta, (uint8_t)((input->key << 2) | input->type));
+    rec->last_time = input->time;
+    rec->events++;
+}
+
+void replay_record_stop(ReplayRecorder* rec, const CyberFishApp* app) {
+    if(!rec->active) return;
+    uint32_t delta = replay_put_gaps(rec, app->ui.now_ms - rec->last_time);
+    replay_put(rec, delta, REPLAY_CODE_END);
+    replay_flush_buf(rec);
+    ReplayDigest digest;
+    replay_digest(&digest, app);
+    storage_file_write(rec->file, &digest, sizeof(digest));
+    storage_file_close(rec->file);
+    storage_file_free(rec->file);
+    furi_record_close(RECORD_STORAGE);
+    rec->file = NULL;
+    rec->active = false;
+}
+
+void replay_run(ReplayResult* result) {
+    memset(result, 0, sizeof(ReplayResult));
+    CyberFishApp* app = malloc(sizeof(CyberFishApp));
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    ReplayHeader header;
+    if(storage_file_open(file, REPLAY_PATH, FSAM_READ, FSOM_OPEN_EXISTING) &&
+       storage_file_read(file, &header, sizeof(header)) == sizeof(header) &&
+       header.magic == REPLAY_MAGIC && header.version == REPLAY_VERSION &&
+       header.app_size == sizeof(CyberFishApp) &&
+       storage_file_read(file, app, sizeof(CyberFishApp)) == sizeof(CyberFishApp)) {
+        uint32_t start = furi_get_tick();
+        uint32_t first = app->ui.now_ms;
+        uint32_t time = first;
+        uint8_t buf[48];
+        size_t len = 0, pos = 0;
+        bool ended = false;
+        while(!ended) {
+            if(pos + REPLAY_RECORD_SIZE > len) {
+                /* Records never straddle a refill since 48 is a multiple of 3 */
+                len = storage_file_read(file, buf, sizeof(buf));
+                pos = 0;
+                if(len < REPLAY_RECORD_SIZE) break;
+            }
+            uint32_t delta = buf[pos] | (buf[pos + 1] << 8);
+            uint8_t code = buf[pos + 2];
+            pos += REPLAY_RECORD_SIZE;
+            time += delta;
+            if(code == REPLAY_CODE_GAP) continue;
+            if(code == REPLAY_CODE_END) {
+                /* Timers still running when the recording stopped */
+                if(game_step(app, NULL, time) & GameEffectSave) result->saves++;
+                ended = true;
+                break;
+            }
+            GameInput input = {.key = (GameKey)(code >> 2), .type = (GameInputType)(code & 1), .time = time};
+            if(game_step(app, &input, time) & GameEffectSave) result->saves++;
+            result->events++;
+        }
+        result->elapsed_ms = furi_get_tick() - start;
+        result->span_ms = time - first;
+
+        ReplayDigest* expected = &result->expected;
+        /* The digest follows the END record, which may sit mid-buffer */
+        if(ended && len - pos >= sizeof(ReplayDigest)) {
+            memcpy(expected, &buf[pos], sizeof(ReplayDigest));
+            result->loaded = true;
+        } else if(ended) {
+            size_t have = len - pos;
+            memcpy(expected, &buf[pos], have);
+            result->loaded = storage_file_read(file, (uint8_t*)expected + have, sizeof(ReplayDigest) - have) ==
+                             sizeof(ReplayDigest) - have;
+        }
+        replay_digest(&result->actual, app);
+        result->match = result->loaded && memcmp(expected, &result->actual, sizeof(ReplayDigest)) == 0;
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    free(app);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <storage/storage.h>
+
+#include "cyber_fishing_game.h"
+
+/*
+ * Deterministic session record/replay.
+ *
+ * A recording starts with a snapshot of CyberFishApp (which includes the
+ * PRNG state and game clock), followed by one 3-byte record per input: the
+ * ms since the previous input and the key/type. It ends with a digest of
+ * the final state and save image. Since game_step() only depends on input
+ * times, replaying feeds the same inputs at the same clock times, skipping
+ * the timed wakeups in between, and compares the digest.
+ */
+
+#define REPLAY_MAGIC 0x43524643u /* "CFRC" */
+#define REPLAY_VERSION 8
+
+typedef struct {
+    File* file;
+    uint32_t last_time;
+    uint32_t events;
+    uint8_t buf[48];
+    uint8_t buf_len;
+    bool active;
+} ReplayRecorder;
+
+/* Final state of a run: clock, PRNG, screen and a CRC of the save image */
+typedef struct {
+    uint32_t time;
+    uint32_t rng_state;
+    uint32_t state;
+    uint32_t save_crc;
+} ReplayDigest;
+
+typedef struct {
+    bool loaded;
+    bool match;
+    uint32_t span_ms; /* Game time covered by the recording */
+    uint32_t events;
+    uint32_t saves;
+    uint32_t elapsed_ms;
+    ReplayDigest expected; /* As recorded, valid if loaded */
+    ReplayDigest actual; /* Of the replayed state */
+} ReplayResult;
+
+void replay_recorder_init(ReplayRecorder* rec);
+
+bool replay_record_start(ReplayRecorder* rec, const CyberFishApp* app);
+
+/* Call before each game_step() that is fed an input */
+void replay_record_input(ReplayRecorder* rec, const GameInput* input);
+
+void replay_record_stop(ReplayRecorder* rec, const CyberFishApp* app);
+
+/* Replays the last recording into a scratch app; never touches the real save */
+void replay_run(ReplayResult* result);
@@ -0,0 +1,284 @@
+#include "cyber_fishing_save.h"
+
+#include "cyber_fishing_trawler.h"
+
+#include <furi.h>
+#include <furi_hal.h>
+#include <stddef.h>
+#include <storage/storage.h>
+#include <string.h>
+
+#define SAVE_DIR EXT_PATH("apps_data")
+#define SAVE_PATH EXT_PATH("apps_data/cyber_fishing.save")
+#define SAVE_TMP_PATH EXT_PATH("apps_data/cyber_fishing.save.tmp")
+
+uint32_t save_crc32(const uint8_t* data, size_t len) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for(size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for(int b = 0; b < 8; b++) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+    return ~crc;
+}
+
+static uint8_t* put_u32(uint8_t* p, uint32_t v) {
+    p[0] = v & 0xFF; p[1] = (v >> 8) & 0xFF; p[2] = (v >> 16) & 0xFF; p[3] = (v >> 24) & 0xFF;
+    return p + 4;
+}
+
+static uint32_t get_u32(const uint8_t** p) {
+    const uint8_t* b = *p;
+    *p += 4;
+    return (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+}
+
+size_t save_encode(const CyberFishApp* app, uint8_t* out) {
+    return save_encode_stamped(app, out, app->progress.saved_at);
+}
+
+size_t save_encode_stamped(const CyberFishApp* app, uint8_t* out, uint32_t saved_at) {
+    uint16_t len = SAVE_PAYLOAD_SIZE;
+    memcpy(out + SAVE_HEADER_SIZE, &app->progress, len);
+    memcpy(out + SAVE_HEADER_SIZE + offsetof(CyberFishProgress, saved_at), &saved_at, sizeof(saved_at));
+    uint8_t* h = put_u32(out, SAVE_MAGIC);
+    h[0] = SAVE_VERSION & 0xFF; h[1] = SAVE_VERSION >> 8;
+    h[2] = len & 0xFF; h[3] = len >> 8;
+    put_u32(h + 4, save_crc32(out + SAVE_HEADER_SIZE, len));
+    return SAVE_HEADER_SIZE + len;
+}
+
+static uint8_t clamp_level(uint32_t lvl) {
+    return lvl > LEVEL_MAX ? LEVEL_MAX : (uint8_t)lvl;
+}
+
+/* Layouts before v4 had one fixed slot per packet for the seven built-in packets */
+#define SAVE_OLD_PKT_COUNT 7
+
+/* v3 payload: the packed record as it was before the content registry */
+typedef struct __attribute__((packed)) {
+    uint32_t credits;
+    uint32_t high_score;
+    uint32_t inv[SAVE_OLD_PKT_COUNT];
+    uint16_t core_ver;
+    uint8_t buffer_lvl;
+    uint8_t antenna_lvl;
+    uint8_t lure_lvl;
+    uint8_t current_world : 3;
+    uint8_t reserved : 5;
+    uint8_t discovered;
+    uint8_t world_unlocked;
+} SaveV3Progress;
+
+_Static_assert(sizeof(SaveV3Progress) == 44, "v3 layout changed");
+
+/* Moves fixed per-packet counts and masks into stacks and the discovery bitset */
+static void save_migrate_inv(CyberFishProgress* pr, const uint32_t* inv, uint8_t discovered, uint8_t worlds) {
+    pr->inv_used = 0;
+    for(int i=0; i<SAVE_OLD_PKT_COUNT; i++) {
+        if(inv[i] == 0) continue;
+        pr->inv[pr->inv_used].pkt = i;
+        pr->inv[pr->inv_used].count = inv[i];
+        pr->inv_used++;
+    }
+    pr->discovered[0] = discovered & 0x7F;
+    pr->world_unlocked = worlds;
+}
+
+/* v1 and v2 share the leading seven words and inv[] */
+static const uint8_t* save_decode_words(CyberFishProgress* pr, uint32_t* inv, const uint8_t* p) {
+    pr->credits = get_u32(&p);
+    pr->high_score = get_u32(&p);
+    pr->buffer_lvl = clamp_level(get_u32(&p));
+    pr->antenna_lvl = clamp_level(get_u32(&p));
+    pr->lure_lvl = clamp_level(get_u32(&p));
+    uint32_t world = get_u32(&p);
+    pr->current_world = world < CONTENT_MAX_WORLDS ? world : 0;
+    uint32_t core_ver = get_u32(&p);
+    pr->core_ver = core_ver > CORE_VER_MAX ? CORE_VER_MAX : core_ver;
+    for(int i=0; i<SAVE_OLD_PKT_COUNT; i++) inv[i] = get_u32(&p);
+    return p;
+}
+
+static void save_decode_legacy(CyberFishProgress* pr, const uint8_t* data) {
+    uint32_t inv[SAVE_OLD_PKT_COUNT];
+    const uint8_t* p = save_decode_words(pr, inv, data);
+    uint8_t discovered = 0, worlds = 0;
+    for(int i=0; i<SAVE_OLD_PKT_COUNT; i++) if(*p++) discovered |= 1 << i;
+    for(int i=0; i<5; i++) if(*p++) worlds |= 1 << i;
+    save_migrate_inv(pr, inv, discovered, worlds);
+}
+
+static void save_decode_v3(CyberFishProgress* pr, const uint8_t* p, size_t len) {
+    SaveV3Progress old;
+    memset(&old, 0, sizeof(old));
+    memcpy(&old, p, len);
+    pr->credits = old.credits;
+    pr->high_score = old.high_score;
+    pr->core_ver = old.core_ver;
+    pr->buffer_lvl = old.buffer_lvl;
+    pr->antenna_lvl = old.antenna_lvl;
+    pr->lure_lvl = old.lure_lvl;
+    pr->current_world = old.current_world;
+    uint32_t inv[SAVE_OLD_PKT_COUNT];
+    memcpy(inv, old.inv, sizeof(inv));
+    save_migrate_inv(pr, inv, old.discovered, old.world_unlocked);
+}
+
+bool save_decode(CyberFishProgress* pr, const uint8_t* data, size_t len) {
+    memset(pr, 0, sizeof(CyberFishProgress));
+    const uint8_t* p = data;
+    if(len == SAVE_LEGACY_SIZE && get_u32(&p) != SAVE_MAGIC) {
+        save_decode_legacy(pr, data);
+        return true;
+    }
+
+    p = data;
+    if(len < SAVE_HEADER_SIZE || get_u32(&p) != SAVE_MAGIC) return false;
+    uint16_t version = p[0] | (p[1] << 8);
+    uint16_t payload = p[2] | (p[3] << 8);
+    p += 4;
+    uint32_t crc = get_u32(&p);
+    if(len < SAVE_HEADER_SIZE + (size_t)payload) return false;
+    if(save_crc32(p, payload) != crc) return false;
+
+    if(version == 2 && payload == SAVE_V2_PAYLOAD_SIZE) {
+        uint32_t inv[SAVE_OLD_PKT_COUNT];
+        p = save_decode_words(pr, inv, p);
+        save_migrate_inv(pr, inv, p[0], p[1]);
+    } else if(version == 3 && payload <= sizeof(SaveV3Progress)) {
+        save_decode_v3(pr, p, payload);
+    } else if(version == SAVE_VERSION && payload <= sizeof(CyberFishProgress)) {
+        /* Fields appended after this save was written stay zero */
+        memcpy(pr, p, payload);
+        if(pr->inv_used > INV_SLOTS) return false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/* Drops what the save refers to but the loaded content lacks, as after switching to a smaller pack */
+static void save_fit_content(CyberFishProgress* pr) {
+    uint16_t packets = content_packet_count();
+    uint8_t used = 0;
+    for(uint8_t i=0; i<pr->inv_used; i++) {
+        InvStack stack = pr->inv[i];
+        if(stack.pkt >= packets || stack.count == 0) continue;
+        /* A packet can only hold one stack; fold repeats into the first */
+        uint8_t j = 0;
+        while(j < used && pr->inv[j].pkt != stack.pkt) j++;
+        if(j == used) {
+            pr->inv[used++] = stack;
+        } else {
+            uint32_t room = UINT32_MAX - pr->inv[j].count;
+            pr->inv[j].count += stack.count < room ? stack.count : room;
+        }
+    }
+    memset(&pr->inv[used], 0, (INV_SLOTS - used) * sizeof(InvStack));
+    pr->inv_used = used;
+    for(int w=0; w<DISCOVERED_WORDS; w++) {
+        uint16_t first = w * 32;
+        if(first >= packets) pr->discovered[w] = 0;
+        else if(packets - first < 32) pr->discovered[w] &= (1u << (packets - first)) - 1;
+    }
+    pr->world_unlocked &= (1u << content_world_count()) - 1;
+    pr->world_unlocked |= 1 << 0;
+}
+
+static bool save_read_file(Storage* storage, const char* path, CyberFishProgress* pr) {
+    uint8_t image[SAVE_FILE_MAX];
+    size_t len = 0;
+    File* file = storage_file_alloc(storage);
+    if(storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        len = storage_file_read(file, image, sizeof(image));
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+    if(len == 0 || !save_decode(pr, image, len)) return false;
+    return pr->current_world < content_world_count();
+}
+
+void load_game(CyberFishApp* app) {
+    reset_game(app);
+    app->progress.core_ver = 1;
+    app->progress.high_score = 0;
+    /* Decoded into scratch, so a bad file never leaves half-applied progress */
+    CyberFishProgress loaded;
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    /* A valid temp file means we died between writing it and the rename */
+    if(save_read_file(storage, SAVE_PATH, &loaded) || save_read_file(storage, SAVE_TMP_PATH, &loaded)) {
+        app->progress = loaded;
+    }
+    furi_record_close(RECORD_STORAGE);
+    if(app->progress.core_ver == 0) app->progress.core_ver = 1;
+    save_fit_content(&app->progress);
+    game_sync_discovered(app);
+    app->ui.trawled = 0;
+    uint32_t now = furi_hal_rtc_get_timestamp();
+    /* Older saves carry no stamp, and a clock set backwards credits nothing */
+    if((app->progress.settings & SettingAutoTrawler) && app->progress.saved_at && now > app->progress.saved_at) {
+        app->ui.trawled = trawler_run(app, now - app->progress.saved_at);
+    }
+}
+
+void save_engine_init(SaveEngine* engine) {
+    memset(engine, 0, sizeof(SaveEngine));
+}
+
+void save_mark_dirty(SaveEngine* engine, uint32_t now) {
+    if(!engine->dirty) engine->first_dirty = now;
+    engine->last_dirty = now;
+    engine->dirty = true;
+}
+
+bool save_replace_file(Storage* storage, const char* tmp, const char* path) {
+    if(storage_common_rename(storage, tmp, path) == FSE_OK) return true;
+    storage_common_remove(storage, path);
+    return storage_common_rename(storage, tmp, path) == FSE_OK;
+}
+
+static bool save_write_image(SaveEngine* engine, const uint8_t* image, size_t len) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    storage_common_mkdir(storage, SAVE_DIR);
+    File* file = storage_file_alloc(storage);
+    bool ok = false;
+    if(storage_file_open(file, SAVE_TMP_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
+        ok = storage_file_write(file, image, len) == len;
+        engine->writes++;
+        engine->bytes_written += len;
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+    ok = ok && save_replace_file(storage, SAVE_TMP_PATH, SAVE_PATH);
+    furi_record_close(RECORD_STORAGE);
+    return ok;
+}
+
+void save_flush(SaveEngine* engine, const CyberFishApp* app) {
+    if(!engine->dirty) return;
+    uint8_t image[SAVE_IMAGE_MAX];
+    /* Only the image is stamped, so replays of the in-memory state stay deterministic */
+    size_t len = save_encode_stamped(app, image, furi_hal_rtc_get_timestamp());
+    engine->flushes++;
+    if(save_write_image(engine, image, len)) {
+        engine->dirty = false;
+    } else {
+        /* Keep the dirty flag so the next poll retries */
+        engine->failures++;
+    }
+}
+
+uint32_t save_poll(SaveEngine* engine, const CyberFishApp* app, uint32_t now) {
+    if(!engine->dirty) return FuriWaitForever;
+    uint32_t quiet = now - engine->last_dirty;
+    uint32_t held = now - engine->first_dirty;
+    if(quiet >= SAVE_DEBOUNCE_MS || held >= SAVE_MAX_DELAY_MS) {
+        save_flush(engine, app);
+        if(!engine->dirty) return FuriWaitForever;
+        engine->first_dirty = engine->last_dirty = now;
+        return SAVE_DEBOUNCE_MS;
+    }
+    uint32_t wait = SAVE_DEBOUNCE_MS - quiet;
+    if(SAVE_MAX_DELAY_MS - held < wait) wait = SAVE_MAX_DELAY_MS - held;
+    return wait;
+}
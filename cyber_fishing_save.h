@@ -0,0 +1,84 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <storage/storage.h>
+
+#include "cyber_fishing_game.h"
+
+/*
+ * Save subsystem. Game code only marks the state dirty; the image is
+ * serialized into one buffer and flushed on a debounce or on exit. Each
+ * flush goes to a temp file that is renamed over the real save, and the
+ * header carries a version and CRC so torn files are rejected on load.
+ */
+
+#define SAVE_MAGIC 0x48534643u /* "CFSH" */
+#define SAVE_VERSION 4
+#define SAVE_HEADER_SIZE 12
+/* The v4 payload is the packed CyberFishProgress record itself */
+#define SAVE_PAYLOAD_SIZE sizeof(CyberFishProgress)
+#define SAVE_IMAGE_MAX (SAVE_HEADER_SIZE + SAVE_PAYLOAD_SIZE)
+/* Largest file load_game() accepts, leaving room for older layouts */
+#define SAVE_FILE_MAX 256
+
+/* v2 payload: seven words, inv[7] and two bitmask bytes */
+#define SAVE_V2_PAYLOAD_SIZE (7 * 4 + 7 * 4 + 2)
+/* Headerless v1 image: seven words, inv[7], discovered[7], world_unlocked[5] */
+#define SAVE_LEGACY_SIZE (7 * 4 + 7 * 4 + 7 + 5)
+
+_Static_assert(SAVE_IMAGE_MAX <= SAVE_FILE_MAX, "save image over budget");
+
+/* Flush once the state has been quiet this long... */
+#define SAVE_DEBOUNCE_MS 2000
+/* ...but never hold unsaved progress for longer than this */
+#define SAVE_MAX_DELAY_MS 10000
+
+typedef struct {
+    bool dirty;
+    uint32_t first_dirty;
+    uint32_t last_dirty;
+    uint32_t flushes;
+    uint32_t writes;
+    uint32_t bytes_written;
+    uint32_t failures;
+} SaveEngine;
+
+uint32_t save_crc32(const uint8_t* data, size_t len);
+
+/*
+ * Renames a fully written temp file over path. Older firmware refuses to
+ * rename over an existing file, so that case removes path first; a crash
+ * in between leaves only the temp file, which loaders fall back to.
+ */
+bool save_replace_file(Storage* storage, const char* tmp, const char* path);
+
+/* Serializes the persistent part of app into SAVE_IMAGE_MAX bytes. Returns the image size. */
+size_t save_encode(const CyberFishApp* app, uint8_t* out);
+
+/* As save_encode, with saved_at replaced by the given RTC timestamp */
+size_t save_encode_stamped(const CyberFishApp* app, uint8_t* out, uint32_t saved_at);
+
+/*
+ * Decodes an image into progress, returns false if it is torn or corrupt.
+ * progress is scratch until this returns true.
+ */
+bool save_decode(CyberFishProgress* progress, const uint8_t* data, size_t len);
+
+void save_engine_init(SaveEngine* engine);
+
+/*
+ * Loads the save into app, falling back to defaults if none is valid. With
+ * the auto-trawler on, also credits the catches made since the save was
+ * written; app->ui.trawled says how many.
+ */
+void load_game(CyberFishApp* app);
+
+void save_mark_dirty(SaveEngine* engine, uint32_t now);
+
+/* Flushes if the debounce has expired. Returns ms until the next deadline. */
+uint32_t save_poll(SaveEngine* engine, const CyberFishApp* app, uint32_t now);
+
+/* Writes immediately if anything is pending */
+void save_flush(SaveEngine* engine, const CyberFishApp* app);
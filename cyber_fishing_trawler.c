@@ -0,0 +1,66 @@
+#include "cyber_fishing_trawler.h"
+
+uint32_t trawler_mean_wait_ms(int32_t base) {
+    /* Draws u < floor - base are clamped to the floor; the rest wait u + base */
+    int64_t n = GAME_CAST_SPREAD_MS;
+    int64_t k = (int64_t)GAME_TICK_MS - base;
+    if(k < 0) k = 0;
+    if(k > n) k = n;
+    /* Sum of u over [k, n) is (n - 1 + k) * (n - k) / 2 */
+    int64_t sum = k * GAME_TICK_MS + (n - k) * base + (n - 1 + k) * (n - k) / 2;
+    return (uint32_t)((sum + n / 2) / n);
+}
+
+uint64_t trawler_expected_catches(const CyberFishApp* app, uint32_t elapsed_s) {
+    if(elapsed_s > TRAWLER_MAX_S) elapsed_s = TRAWLER_MAX_S;
+    uint64_t cycle = trawler_mean_wait_ms(game_cast_base_ms(app)) + TRAWLER_HANDLE_MS;
+    return (uint64_t)elapsed_s * 1000 * TRAWLER_YIELD_PCT / 100 / cycle;
+}
+
+static uint32_t isqrt64(uint64_t v) {
+    uint64_t r = 0, bit = 1ull << 62;
+    while(bit > v) bit >>= 2;
+    while(bit) {
+        if(v >= r + bit) {
+            v -= r + bit;
+            r = (r >> 1) + bit;
+        } else {
+            r >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)r;
+}
+
+/*
+ * Expected count plus noise with roughly the binomial spread. The noise is
+ * the sum of three uniforms (Irwin-Hall), so it never strays more than
+ * three standard deviations from the mean.
+ */
+static uint32_t trawler_sample(uint64_t mean_milli, uint32_t* rng) {
+    int64_t sd_milli = isqrt64(mean_milli * 1000);
+    int64_t spread = (int64_t)rng_range(rng, 1024) + rng_range(rng, 1024) + rng_range(rng, 1024) - 1536;
+    int64_t count = ((int64_t)mean_milli + sd_milli * spread / 512 + 500) / 1000;
+    if(count < 0) return 0;
+    return count > UINT32_MAX ? UINT32_MAX : (uint32_t)count;
+}
+
+uint32_t trawler_run(CyberFishApp* app, uint32_t elapsed_s) {
+    uint64_t casts = trawler_expected_catches(app, elapsed_s);
+    if(casts == 0) return 0;
+    game_sync_rarity(app);
+    uint64_t added = 0;
+    for(int t=0; t<RARITY_TIERS; t++) {
+        if(app->rarity.weight[t] == 0) continue;
+        uint16_t first, count;
+        content_tier_range(t, &first, &count);
+        /* A tier's share is split evenly over its packets, like a bite picks one */
+        uint64_t mean_milli = casts * 1000 * app->rarity.weight[t] / RARITY_ROLLS / count;
+        for(uint16_t p=first; p<first+count; p++) {
+            uint32_t n = trawler_sample(mean_milli, &app->rng_state);
+            game_add_packets(app, p, n);
+            added += n;
+        }
+    }
+    return added > UINT32_MAX ? UINT32_MAX : (uint32_t)added;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "cyber_fishing_game.h"
+
+/*
+ * Offline auto-trawler. When the app is reopened, the catches it would
+ * have made in the elapsed real time are credited in closed form: the
+ * number of casts comes from the mean of the cast wait, and each packet
+ * type gets its expected share from the rarity table, plus bounded noise.
+ * The work is per packet type, however long the app was closed.
+ *
+ * The trawler reels in every bite but is slower than a player:
+ * TRAWLER_HANDLE_MS per cast for reeling in and recasting, and only
+ * TRAWLER_YIELD_PCT of what it brings up is kept.
+ */
+
+#define TRAWLER_HANDLE_MS 1500
+#define TRAWLER_YIELD_PCT 50
+/* Offline time past this is not credited */
+#define TRAWLER_MAX_S (7 * 24 * 3600)
+
+/* Mean cast-to-bite wait, exactly E[max(U + base, GAME_TICK_MS)] over the integer draws */
+uint32_t trawler_mean_wait_ms(int32_t base);
+
+/* Expected packets kept over elapsed_s, before the per-type split */
+uint64_t trawler_expected_catches(const CyberFishApp* app, uint32_t elapsed_s);
+
+/* Credits the offline catches to the hold, returns how many were added */
+uint32_t trawler_run(CyberFishApp* app, uint32_t elapsed_s);
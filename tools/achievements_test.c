@@ -0,0 +1,178 @@
+/*
+ * Host tests for the achievement rules.
+ *
+ *  - Each rule in achievement_rules, subscribed on its own bus, stays
+ *    locked one short of its target and for events its world or subject
+ *    filter rejects, unlocks on the event that reaches the target, and
+ *    never reports itself again.
+ *  - The bus itself: a publish runs only the handlers of its event type,
+ *    in the order they subscribed, is true if any of them is, and a full
+ *    bus turns further subscriptions away.
+ *  - The unlock bits and counters survive save_encode()/save_decode() for
+ *    every single rule and for all of them, and a save written to and
+ *    loaded back from the storage stand-in.
+ *
+ * Built and run by `make test` in this directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cyber_fishing_save.h"
+#include "host_test.h"
+
+/* Publishes one event carrying amount as both its count and its credits */
+static bool ach_publish(const EventBus* bus, AchievementState* state, const GameEvent* base, uint32_t amount) {
+    GameEvent event = *base;
+    event.count = amount;
+    event.credits = amount;
+    return event_publish(bus, state, &event);
+}
+
+typedef struct {
+    uint16_t calls[8];
+    int count;
+} BusLog;
+
+/* Records its arg; args of 100 and up report the event */
+static bool bus_record(void* target, const GameEvent* event, uint16_t arg) {
+    BusLog* log = target;
+    if(log->count < 8) log->calls[log->count++] = arg;
+    return arg >= 100;
+}
+
+static void test_bus(void) {
+    static EventBus bus;
+    memset(&bus, 0, sizeof(bus));
+    CHECK(event_subscribe(&bus, GameEventSell, bus_record, 1));
+    CHECK(event_subscribe(&bus, GameEventCatch, bus_record, 2));
+    CHECK(event_subscribe(&bus, GameEventSell, bus_record, 3));
+    CHECK(event_subscribe(&bus, GameEventCatch, bus_record, 104));
+    CHECK(event_subscribe(&bus, GameEventSell, bus_record, 5));
+
+    BusLog log = {0};
+    GameEvent event = {.type = GameEventSell};
+    CHECK(!event_publish(&bus, &log, &event));
+    CHECK_EQ(log.count, 3);
+    CHECK_EQ(log.calls[0], 1);
+    CHECK_EQ(log.calls[1], 3);
+    CHECK_EQ(log.calls[2], 5);
+
+    memset(&log, 0, sizeof(log));
+    event.type = GameEventCatch;
+    CHECK(event_publish(&bus, &log, &event));
+    CHECK_EQ(log.count, 2);
+    CHECK_EQ(log.calls[0], 2);
+    CHECK_EQ(log.calls[1], 104);
+
+    /* No subscribers, no calls */
+    memset(&log, 0, sizeof(log));
+    event.type = GameEventPrestige;
+    CHECK(!event_publish(&bus, &log, &event));
+    CHECK_EQ(log.count, 0);
+
+    while(bus.count < EVENT_MAX_SUBSCRIBERS) CHECK(event_subscribe(&bus, GameEventTravel, bus_record, 0));
+    CHECK(!event_subscribe(&bus, GameEventTravel, bus_record, 0));
+    CHECK_EQ(bus.count, EVENT_MAX_SUBSCRIBERS);
+    /* The chains made before it filled are intact */
+    memset(&log, 0, sizeof(log));
+    event.type = GameEventSell;
+    event_publish(&bus, &log, &event);
+    CHECK_EQ(log.count, 3);
+}
+
+static void test_rule(uint16_t id, AchievementState* all) {
+    const AchievementRule* rule = &achievement_rules[id];
+    static EventBus bus;
+    memset(&bus, 0, sizeof(bus));
+    CHECK(achievements_subscribe(&bus, rule, 1));
+    AchievementState state;
+    memset(&state, 0, sizeof(state));
+
+    GameEvent match = {
+        .type = rule->event,
+        .world = rule->world == ACH_ANY ? 0 : rule->world,
+        .subject = rule->subject == ACH_ANY ? 0 : rule->subject,
+    };
+    GameEvent misses[2];
+    int miss_count = 0;
+    if(rule->world != ACH_ANY) {
+        misses[miss_count] = match;
+        misses[miss_count++].world = rule->world + 1;
+    }
+    if(rule->subject != ACH_ANY) {
+        misses[miss_count] = match;
+        misses[miss_count++].subject = rule->subject + 1;
+    }
+
+    uint32_t target = rule->target;
+    if(target > 1) CHECK(!ach_publish(&bus, &state, &match, target - 1));
+    if(rule->counter != ACH_NO_COUNTER) {
+        /* The counters count every event; only the rule itself is filtered */
+        uint32_t step = target > 0 ? 1 : 0;
+        for(int m=0; m<miss_count; m++, step = 0) CHECK(!ach_publish(&bus, &state, &misses[m], step));
+        CHECK(!achievement_unlocked(&state, 0));
+        CHECK(ach_publish(&bus, &state, &match, step));
+    } else {
+        for(int m=0; m<miss_count; m++) CHECK(!ach_publish(&bus, &state, &misses[m], target));
+        CHECK(!achievement_unlocked(&state, 0));
+        CHECK(ach_publish(&bus, &state, &match, target));
+    }
+    CHECK(achievement_unlocked(&state, 0));
+    /* Once unlocked, nothing reports it again */
+    CHECK(!ach_publish(&bus, &state, &match, target));
+    CHECK(!ach_publish(&bus, &state, &match, target + 1));
+    CHECK_EQ(achievements_unlocked_count(&state), 1);
+    if(!achievement_unlocked(&state, 0)) fprintf(stderr, "rule %u (%s) did not unlock\n", id, rule->name);
+    all->unlocked[id >> 5] |= 1u << (id & 31);
+}
+
+static void ach_round_trip(CyberFishApp* app, const AchievementState* state) {
+    app->progress.achievements = *state;
+    uint8_t image[SAVE_IMAGE_MAX];
+    size_t len = save_encode(app, image);
+    CyberFishProgress decoded;
+    CHECK(save_decode(&decoded, image, len));
+    CHECK(memcmp(&decoded.achievements, state, sizeof(AchievementState)) == 0);
+}
+
+static void test_save(const AchievementState* all) {
+    CyberFishApp* app = host_app_new(1);
+    AchievementState state;
+    for(uint16_t id=0; id<achievement_rule_count; id++) {
+        memset(&state, 0, sizeof(state));
+        state.unlocked[id >> 5] = 1u << (id & 31);
+        for(int c=0; c<AchCounters; c++) state.counters[c] = id * 1000 + c;
+        ach_round_trip(app, &state);
+    }
+    state = *all;
+    for(int c=0; c<AchCounters; c++) state.counters[c] = UINT32_MAX - c;
+    ach_round_trip(app, &state);
+
+    /* And through a file, the way the app saves and loads */
+    SaveEngine engine;
+    save_engine_init(&engine);
+    save_mark_dirty(&engine, 0);
+    save_flush(&engine, app);
+    CHECK_EQ(engine.writes, 1);
+    CyberFishApp* loaded = host_app_new(1);
+    load_game(loaded);
+    CHECK(memcmp(&loaded->progress.achievements, &state, sizeof(AchievementState)) == 0);
+    CHECK_EQ(achievements_unlocked_count(&loaded->progress.achievements), achievement_rule_count);
+    free(loaded);
+    free(app);
+}
+
+int main(void) {
+    content_load(NULL);
+    test_bus();
+    AchievementState all;
+    memset(&all, 0, sizeof(all));
+    for(uint16_t id=0; id<achievement_rule_count; id++) test_rule(id, &all);
+    CHECK_EQ(achievements_unlocked_count(&all), achievement_rule_count);
+    /* The game's own bus is needed by load_game's offline trawler */
+    game_events_init();
+    test_save(&all);
+    return host_test_done("achievements_test");
+}
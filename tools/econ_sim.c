@@ -0,0 +1,513 @@
+/*
+ * Host-side Monte Carlo progression simulator for economy tuning.
+ *
+ * Each career starts from a reset save and plays the real game core
+ * (game_step, rarity sampling, pricing, shops) through its input API with
+ * a scripted player until the Nth System Reformat. Careers are independent
+ * and each is seeded from (seed, career index), so results do not depend
+ * on the thread count or on which thread ran which career.
+ *
+ * Careers are split into chunks spread over per-thread deques. A thread
+ * takes work from the back of its own deque and, once that is empty,
+ * steals half of the front of another thread's deque.
+ *
+ * Build from the app directory, overriding economy knobs with -D as needed:
+ *
+ *   cc -O2 -pthread -I. tools/econ_sim.c cyber_fishing_game.c \
+ *      cyber_fishing_content.c cyber_fishing_rarity.c \
+ *      cyber_fishing_entity.c cyber_fishing_events.c \
+ *      cyber_fishing_achievements.c -o econ_sim
+ *   cc ... -DSHOP_ANTENNA_COST=100 -DPRESTIGE_BONUS_PCT=20 ...
+ *
+ * Packet prices and world costs come from a content pack (-k), so they can
+ * be swept without rebuilding. The pack is read into memory once and the
+ * registry's packet cache is locked around each fetch, so -k is safe with
+ * any -j. Writes <prefix>_unlock.csv,
+ * <prefix>_prestige.csv and <prefix>_credits.csv.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cyber_fishing_game.h"
+
+/* Think time the scripted player spends on each menu press */
+#define SIM_PRESS_MS 250
+/* Reaction time is uniform in [SIM_REACT_MIN_MS, SIM_REACT_MIN_MS + react_span) */
+#define SIM_REACT_MIN_MS 250
+#define SIM_CHUNK 256
+#define SIM_MAX_THREADS 256
+#define SIM_MAX_PRESTIGE 16
+/* Histograms and the credit curve have one-minute bins; careers stop at the last one */
+#define SIM_MINUTES 4096
+#define SIM_MINUTE_MS 60000u
+
+typedef struct {
+    uint32_t careers;
+    uint32_t prestiges;
+    uint32_t threads;
+    uint32_t seed;
+    uint32_t react_span;
+    uint32_t upgrade_step; /* Target upgrade level per world reached */
+    const char* prefix;
+} SimConfig;
+
+/* Per-thread results, merged once all threads are done */
+typedef struct {
+    uint32_t unlock[CONTENT_MAX_WORLDS][SIM_MINUTES + 1];
+    uint32_t prestige[SIM_MAX_PRESTIGE][SIM_MINUTES + 1];
+    uint64_t unlock_ms_sum[CONTENT_MAX_WORLDS];
+    uint64_t prestige_ms_sum[SIM_MAX_PRESTIGE];
+    uint64_t credits[SIM_MINUTES];
+    uint32_t unfinished;
+    uint64_t steps;
+} SimResults;
+
+/* A worker's share of the chunk range; the owner pops hi, thieves take lo */
+typedef struct {
+    pthread_mutex_t lock;
+    uint32_t lo;
+    uint32_t hi;
+} SimDeque;
+
+typedef struct {
+    const SimConfig* cfg;
+    SimDeque* deques;
+    uint32_t id;
+    SimResults* results;
+} SimWorker;
+
+typedef struct {
+    CyberFishApp app;
+    uint32_t now;
+    uint32_t rng; /* Player decisions; the game keeps its own stream */
+    uint64_t earned;
+    uint32_t next_minute;
+    uint64_t steps;
+    SimResults* results;
+    /* Rarity per world at the current antenna level, for route planning */
+    RarityTable tables[CONTENT_MAX_WORLDS];
+} SimCareer;
+
+static uint32_t sim_mix(uint32_t seed, uint32_t idx) {
+    uint64_t z = ((uint64_t)seed << 32 | idx) + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return (uint32_t)(z ^ (z >> 31)) | 1;
+}
+
+/* Samples the lifetime-earnings curve at every minute boundary passed */
+static void sim_tick_curve(SimCareer* c) {
+    while(c->next_minute < SIM_MINUTES && (uint64_t)c->next_minute * SIM_MINUTE_MS <= c->now) {
+        c->results->credits[c->next_minute++] += c->earned;
+    }
+}
+
+static uint32_t sim_step(SimCareer* c, const GameInput* input) {
+    uint32_t before = c->app.progress.credits;
+    uint32_t fx = game_step(&c->app, input, c->now);
+    /* Sales raise the balance; purchases and reformats only lower it */
+    if(c->app.progress.credits > before) c->earned += c->app.progress.credits - before;
+    c->steps++;
+    sim_tick_curve(c);
+    return fx;
+}
+
+static uint32_t sim_press_after(SimCareer* c, GameKey key, GameInputType type, uint32_t delay) {
+    c->now += delay;
+    GameInput input = {.key = key, .type = type, .time = c->now};
+    return sim_step(c, &input);
+}
+
+static uint32_t sim_press(SimCareer* c, GameKey key) {
+    return sim_press_after(c, key, GameInputShort, SIM_PRESS_MS);
+}
+
+static uint64_t sim_hold_value(const CyberFishApp* app) {
+    uint64_t value = 0;
+    for(int i=0; i<app->progress.inv_used; i++) {
+        value += (uint64_t)game_price(app->progress.inv[i].pkt, app->progress.core_ver) * app->progress.inv[i].count;
+    }
+    return value;
+}
+
+static void sim_sell_all(SimCareer* c) {
+    if(c->app.progress.inv_used == 0) return;
+    sim_press(c, GameKeyDown);
+    sim_press_after(c, GameKeyRight, GameInputLong, SIM_PRESS_MS);
+    sim_press(c, GameKeyBack);
+}
+
+/* One cast: wait for the bite, react, and dismiss the result screen */
+static void sim_fish(SimCareer* c, uint32_t react_span) {
+    sim_press(c, GameKeyOk);
+    c->now = c->app.ui.deadline;
+    sim_step(c, NULL);
+    uint32_t reaction = SIM_REACT_MIN_MS + rng_range(&c->rng, react_span);
+    sim_press_after(c, GameKeyOk, GameInputShort, reaction);
+    /* A very late press already dismissed LOST PKT itself */
+    uint8_t state = c->app.ui.current_state;
+    if(state == StateCaught || state == StateLost) {
+        sim_press_after(c, GameKeyOk, GameInputShort, state == StateLost ? GAME_LOST_HOLD_MS : SIM_PRESS_MS);
+    }
+}
+
+static void sim_buy(SimCareer* c, int item) {
+    sim_press(c, GameKeyUp);
+    for(int i=0; i<item; i++) sim_press(c, GameKeyDown);
+    sim_press(c, GameKeyOk);
+    sim_press(c, GameKeyBack);
+}
+
+/* Unlocks a world if needed and travels there; the player is back on the dock afterwards */
+static void sim_travel(SimCareer* c, int world) {
+    bool locked = !game_world_unlocked(&c->app, world);
+    sim_press(c, GameKeyUp);
+    sim_press(c, GameKeyRight);
+    for(int i=0; i<world; i++) sim_press(c, GameKeyDown);
+    sim_press(c, GameKeyOk);
+    if(locked) sim_press(c, GameKeyOk);
+}
+
+static bool sim_tier_missing(const CyberFishApp* app, int tier) {
+    uint16_t first, count;
+    content_tier_range(tier, &first, &count);
+    for(uint16_t p=first; p<first+count; p++) if(!game_discovered(app, p)) return true;
+    return false;
+}
+
+/*
+ * World to fish in: the deepest one unlocked, unless a tier still missing
+ * from the Net Index can no longer roll there. Deep worlds push the roll
+ * past the common tiers, so a player who rushed ahead has to go back.
+ */
+static int sim_fishing_world(SimCareer* c) {
+    const CyberFishApp* app = &c->app;
+    int deepest = 0;
+    for(int w=0; w<content_world_count(); w++) if(game_world_unlocked(app, w)) deepest = w;
+    for(int t=0; t<RARITY_TIERS; t++) {
+        if(!sim_tier_missing(app, t)) continue;
+        for(int w=deepest; w>=0; w--) {
+            if(!game_world_unlocked(app, w)) continue;
+            RarityTable* table = &c->tables[w];
+            if(table->world != content_world(w)->depth || table->antenna_lvl != app->progress.antenna_lvl) {
+                rarity_table_build(table, app->progress.antenna_lvl, content_world(w)->depth);
+            }
+            if(table->weight[t]) return w;
+        }
+    }
+    return deepest;
+}
+
+static void sim_prestige(SimCareer* c) {
+    sim_press(c, GameKeyUp);
+    sim_press(c, GameKeyLeft);
+    sim_press(c, GameKeyOk);
+}
+
+static void sim_record(uint32_t* hist, uint64_t* sum, uint32_t now) {
+    uint32_t minute = now / SIM_MINUTE_MS;
+    hist[minute < SIM_MINUTES ? minute : SIM_MINUTES]++;
+    *sum += now;
+}
+
+/*
+ * Scripted player: unlock the next world as soon as credits plus the
+ * hold cover it, otherwise keep each upgrade at upgrade_step levels per
+ * world unlocked, fish where sim_fishing_world() says, and reformat as
+ * soon as the Net Index is complete.
+ */
+static void sim_career(const SimConfig* cfg, uint32_t idx, SimResults* results) {
+    static const uint32_t shop_cost[3] = {SHOP_BUFFER_COST, SHOP_ANTENNA_COST, SHOP_LURE_COST};
+    SimCareer c;
+    memset(&c, 0, sizeof(c));
+    game_init(&c.app);
+    c.results = results;
+    for(int w=0; w<CONTENT_MAX_WORLDS; w++) c.tables[w].world = -1;
+    c.rng = sim_mix(cfg->seed, idx);
+    reset_game(&c.app);
+    c.app.progress.core_ver = 1;
+    game_seed(&c.app, sim_mix(cfg->seed ^ 0xA5A5A5A5u, idx));
+    game_start(&c.app, 0);
+    c.now = GAME_SPLASH_MS;
+    sim_step(&c, NULL);
+
+    uint32_t prestiges = 0;
+    uint16_t unlocked = c.app.progress.world_unlocked;
+    uint32_t limit = SIM_MINUTES * SIM_MINUTE_MS;
+    while(prestiges < cfg->prestiges && c.now < limit) {
+        if(c.app.ui.current_state != StateWaiting) {
+            /* The script lost track of the menus; leave the career unfinished */
+            break;
+        }
+        if(game_index_complete(&c.app)) {
+            sim_prestige(&c);
+            sim_record(results->prestige[prestiges], &results->prestige_ms_sum[prestiges], c.now);
+            prestiges++;
+            unlocked = c.app.progress.world_unlocked;
+            continue;
+        }
+        CyberFishProgress* pr = &c.app.progress;
+        uint64_t worth = pr->credits + sim_hold_value(&c.app);
+        int fishing = sim_fishing_world(&c);
+        int next = 0;
+        while(next < content_world_count() && game_world_unlocked(&c.app, next)) next++;
+        int levels[3] = {pr->buffer_lvl, pr->antenna_lvl, pr->lure_lvl};
+        int target = cfg->upgrade_step * next;
+        int item = -1;
+        for(int i=0; i<3; i++) {
+            if(levels[i] < target && levels[i] < LEVEL_MAX && (item < 0 || levels[i] < levels[item])) item = i;
+        }
+        if(next < content_world_count() && worth >= content_world(next)->cost) {
+            if(pr->credits < content_world(next)->cost) sim_sell_all(&c);
+            sim_travel(&c, next);
+        } else if(item >= 0 && worth >= shop_cost[item]) {
+            if(pr->credits < shop_cost[item]) sim_sell_all(&c);
+            sim_buy(&c, item);
+        } else if(fishing != pr->current_world) {
+            sim_travel(&c, fishing);
+        } else {
+            sim_fish(&c, cfg->react_span);
+        }
+        /* Only the first run is timed from a clean start */
+        uint16_t fresh = c.app.progress.world_unlocked & ~unlocked;
+        if(prestiges == 0) {
+            for(int w=0; w<CONTENT_MAX_WORLDS; w++) {
+                if(fresh >> w & 1) sim_record(results->unlock[w], &results->unlock_ms_sum[w], c.now);
+            }
+        }
+        unlocked = c.app.progress.world_unlocked;
+    }
+    if(prestiges < cfg->prestiges) results->unfinished++;
+    /* Finished careers hold their final earnings for the rest of the curve */
+    c.now = limit;
+    sim_tick_curve(&c);
+    results->steps += c.steps;
+}
+
+static bool sim_take(SimDeque* dq, uint32_t* chunk) {
+    pthread_mutex_lock(&dq->lock);
+    bool ok = dq->lo < dq->hi;
+    if(ok) *chunk = --dq->hi;
+    pthread_mutex_unlock(&dq->lock);
+    return ok;
+}
+
+/* Moves the front half of a victim's range into an empty deque */
+static bool sim_steal(SimDeque* own, SimDeque* victim) {
+    pthread_mutex_lock(&victim->lock);
+    uint32_t left = victim->hi - victim->lo;
+    uint32_t lo = victim->lo, take = (left + 1) / 2;
+    victim->lo += take;
+    pthread_mutex_unlock(&victim->lock);
+    if(take == 0) return false;
+    pthread_mutex_lock(&own->lock);
+    own->lo = lo;
+    own->hi = lo + take;
+    pthread_mutex_unlock(&own->lock);
+    return true;
+}
+
+static void* sim_worker(void* ctx) {
+    SimWorker* w = ctx;
+    const SimConfig* cfg = w->cfg;
+    SimDeque* own = &w->deques[w->id];
+    for(;;) {
+        uint32_t chunk;
+        if(!sim_take(own, &chunk)) {
+            bool stolen = false;
+            for(uint32_t i=1; i<cfg->threads && !stolen; i++) {
+                stolen = sim_steal(own, &w->deques[(w->id + i) % cfg->threads]);
+            }
+            if(!stolen) break;
+            continue;
+        }
+        uint32_t first = chunk * SIM_CHUNK;
+        uint32_t last = first + SIM_CHUNK < cfg->careers ? first + SIM_CHUNK : cfg->careers;
+        for(uint32_t idx = first; idx < last; idx++) sim_career(cfg, idx, w->results);
+    }
+    return NULL;
+}
+
+static uint32_t sim_percentile(const uint32_t* hist, uint64_t total, uint32_t pct) {
+    uint64_t target = (total * pct + 99) / 100, seen = 0;
+    for(uint32_t m=0; m<=SIM_MINUTES; m++) {
+        seen += hist[m];
+        if(seen >= target && target) return m;
+    }
+    return SIM_MINUTES;
+}
+
+static void sim_write_hist(FILE* f, const char* label, int idx, const uint32_t* hist, uint64_t sum_ms) {
+    uint64_t total = 0;
+    for(uint32_t m=0; m<=SIM_MINUTES; m++) total += hist[m];
+    fprintf(f, "%s,%d,%llu,%.2f,%u,%u,%u\n", label, idx, (unsigned long long)total,
+        total ? (double)sum_ms / total / SIM_MINUTE_MS : 0.0,
+        sim_percentile(hist, total, 10), sim_percentile(hist, total, 50), sim_percentile(hist, total, 90));
+}
+
+static FILE* sim_open(const char* prefix, const char* name) {
+    char path[256];
+    snprintf(path, sizeof(path), "%s_%s.csv", prefix, name);
+    FILE* f = fopen(path, "w");
+    if(!f) fprintf(stderr, "cannot write %s\n", path);
+    return f;
+}
+
+static void sim_report(const SimConfig* cfg, const SimResults* r) {
+    FILE* f = sim_open(cfg->prefix, "unlock");
+    if(f) {
+        fprintf(f, "kind,world,reached,mean_min,p10_min,p50_min,p90_min\n");
+        for(int w=1; w<content_world_count(); w++) sim_write_hist(f, "unlock", w, r->unlock[w], r->unlock_ms_sum[w]);
+        fclose(f);
+    }
+    f = sim_open(cfg->prefix, "prestige");
+    if(f) {
+        fprintf(f, "kind,reformat,reached,mean_min,p10_min,p50_min,p90_min\n");
+        for(uint32_t p=0; p<cfg->prestiges; p++) sim_write_hist(f, "prestige", p + 1, r->prestige[p], r->prestige_ms_sum[p]);
+        fclose(f);
+    }
+    f = sim_open(cfg->prefix, "credits");
+    if(f) {
+        fprintf(f, "minute,mean_earned\n");
+        for(uint32_t m=0; m<SIM_MINUTES; m++) fprintf(f, "%u,%.1f\n", m, (double)r->credits[m] / cfg->careers);
+        fclose(f);
+    }
+}
+
+/*
+ * Host-side ContentSource over a pack, read into memory up front so a
+ * fetch is a memcpy rather than a seek and read on a FILE* the workers
+ * would share.
+ */
+typedef struct {
+    uint8_t* data;
+    size_t size;
+    pthread_mutex_t lock;
+} SimPack;
+
+static bool sim_pack_load(SimPack* pack, const char* path) {
+    FILE* f = fopen(path, "rb");
+    if(!f) return false;
+    bool ok = fseek(f, 0, SEEK_END) == 0;
+    long size = ok ? ftell(f) : -1;
+    ok = size > 0 && fseek(f, 0, SEEK_SET) == 0;
+    pack->data = ok ? malloc(size) : NULL;
+    ok = pack->data && fread(pack->data, 1, size, f) == (size_t)size;
+    pack->size = ok ? (size_t)size : 0;
+    fclose(f);
+    return ok;
+}
+
+static bool sim_pack_read(void* ctx, uint32_t offset, void* buf, size_t len) {
+    SimPack* pack = ctx;
+    if(offset > pack->size || len > pack->size - offset) return false;
+    memcpy(buf, pack->data + offset, len);
+    return true;
+}
+
+static void sim_pack_lock(void* ctx) {
+    SimPack* pack = ctx;
+    pthread_mutex_lock(&pack->lock);
+}
+
+static void sim_pack_unlock(void* ctx) {
+    SimPack* pack = ctx;
+    pthread_mutex_unlock(&pack->lock);
+}
+
+static void sim_usage(const char* argv0) {
+    fprintf(stderr,
+        "usage: %s [-n careers] [-p reformats] [-j threads] [-s seed]\n"
+        "          [-r reaction_span_ms] [-u upgrade_step] [-k content.pack] [-o prefix]\n", argv0);
+}
+
+int main(int argc, char** argv) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    SimConfig cfg = {
+        .careers = 100000, .prestiges = 3, .threads = cpus > 0 ? cpus : 1, .seed = 1,
+        .react_span = 500, .upgrade_step = 2, .prefix = "econ",
+    };
+    const char* pack_path = NULL;
+    int opt;
+    while((opt = getopt(argc, argv, "n:p:j:s:r:u:k:o:h")) != -1) {
+        switch(opt) {
+        case 'n': cfg.careers = strtoul(optarg, NULL, 0); break;
+        case 'p': cfg.prestiges = strtoul(optarg, NULL, 0); break;
+        case 'j': cfg.threads = strtoul(optarg, NULL, 0); break;
+        case 's': cfg.seed = strtoul(optarg, NULL, 0); break;
+        case 'r': cfg.react_span = strtoul(optarg, NULL, 0); break;
+        case 'u': cfg.upgrade_step = strtoul(optarg, NULL, 0); break;
+        case 'k': pack_path = optarg; break;
+        case 'o': cfg.prefix = optarg; break;
+        default: sim_usage(argv[0]); return 2;
+        }
+    }
+    if(cfg.prestiges < 1 || cfg.prestiges > SIM_MAX_PRESTIGE) cfg.prestiges = cfg.prestiges < 1 ? 1 : SIM_MAX_PRESTIGE;
+    if(cfg.threads < 1 || cfg.threads > SIM_MAX_THREADS) cfg.threads = cfg.threads < 1 ? 1 : SIM_MAX_THREADS;
+    if(cfg.react_span < 1) cfg.react_span = 1;
+
+    SimPack pack = {0};
+    pthread_mutex_init(&pack.lock, NULL);
+    ContentSource source = {.read = sim_pack_read, .lock = sim_pack_lock, .unlock = sim_pack_unlock, .ctx = &pack};
+    if(pack_path && !content_load(sim_pack_load(&pack, pack_path) ? &source : NULL)) {
+        fprintf(stderr, "%s is not a valid content pack\n", pack_path);
+        return 1;
+    }
+    if(!pack_path) content_load(NULL);
+    game_events_init();
+
+    uint32_t chunks = (cfg.careers + SIM_CHUNK - 1) / SIM_CHUNK;
+    SimDeque* deques = calloc(cfg.threads, sizeof(SimDeque));
+    SimWorker* workers = calloc(cfg.threads, sizeof(SimWorker));
+    pthread_t* threads = calloc(cfg.threads, sizeof(pthread_t));
+    for(uint32_t t=0; t<cfg.threads; t++) {
+        pthread_mutex_init(&deques[t].lock, NULL);
+        deques[t].lo = (uint64_t)chunks * t / cfg.threads;
+        deques[t].hi = (uint64_t)chunks * (t + 1) / cfg.threads;
+        workers[t] = (SimWorker){.cfg = &cfg, .deques = deques, .id = t, .results = calloc(1, sizeof(SimResults))};
+    }
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for(uint32_t t=0; t<cfg.threads; t++) pthread_create(&threads[t], NULL, sim_worker, &workers[t]);
+    for(uint32_t t=0; t<cfg.threads; t++) pthread_join(threads[t], NULL);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    SimResults* total = workers[0].results;
+    for(uint32_t t=1; t<cfg.threads; t++) {
+        const SimResults* r = workers[t].results;
+        for(int w=0; w<CONTENT_MAX_WORLDS; w++) {
+            for(int m=0; m<=SIM_MINUTES; m++) total->unlock[w][m] += r->unlock[w][m];
+            total->unlock_ms_sum[w] += r->unlock_ms_sum[w];
+        }
+        for(int p=0; p<SIM_MAX_PRESTIGE; p++) {
+            for(int m=0; m<=SIM_MINUTES; m++) total->prestige[p][m] += r->prestige[p][m];
+            total->prestige_ms_sum[p] += r->prestige_ms_sum[p];
+        }
+        for(int m=0; m<SIM_MINUTES; m++) total->credits[m] += r->credits[m];
+        total->unfinished += r->unfinished;
+        total->steps += r->steps;
+    }
+    sim_report(&cfg, total);
+
+    double secs = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    fprintf(stderr, "%u careers, %u threads, %.2fs, %.0f careers/s, %.1fM steps/s, %u unfinished\n",
+        cfg.careers, cfg.threads, secs, cfg.careers / secs, total->steps / secs / 1e6, total->unfinished);
+
+    for(uint32_t t=0; t<cfg.threads; t++) {
+        pthread_mutex_destroy(&deques[t].lock);
+        free(workers[t].results);
+    }
+    free(deques);
+    free(workers);
+    free(threads);
+    content_load(NULL);
+    free(pack.data);
+    pthread_mutex_destroy(&pack.lock);
+    return 0;
+}
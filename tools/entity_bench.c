@@ -0,0 +1,127 @@
+/*
+ * Host-side benchmark for the swimming-packet entity pool.
+ *
+ * Runs the per-frame work of the fishing view for growing pool sizes:
+ * entity_pool_update(), entity_pool_visible() and an 8x5 XBM blit into a
+ * 128x64 1-bit frame buffer laid out like the Flipper canvas. Reports the
+ * mean cost per frame and the largest pool that fits a share of the frame
+ * budget, at the game tick (100 ms) and at the Smooth FX rate (33 ms).
+ *
+ * Host timings are scaled by a slowdown factor (-x) to estimate the device.
+ * Calibrate it against the "bg" probe on the device's PERF screen, which
+ * times draw_world_bg() with the default pool.
+ *
+ * Build from the app directory; the pool capacity is a compile-time size:
+ *
+ *   cc -O2 -I. -DENTITY_MAX=4096 tools/entity_bench.c cyber_fishing_entity.c \
+ *      cyber_fishing_content.c cyber_fishing_rarity.c -o entity_bench
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cyber_fishing_content.h"
+#include "cyber_fishing_entity.h"
+
+/* GAME_TICK_MS and GAME_FRAME_FAST_MS; cyber_fishing_game.h asserts the default pool size */
+#define BENCH_TICK_MS 100
+#define BENCH_FAST_MS 33
+#define BENCH_SCREEN_H 64
+#define BENCH_MAX_RATES 2
+
+typedef struct {
+    uint32_t frames;
+    uint32_t budget_pct;
+    double slowdown;
+    int world;
+} BenchConfig;
+
+static uint8_t frame_buffer[ENTITY_SCREEN_W / 8 * BENCH_SCREEN_H];
+static EntitySprite sprites[ENTITY_MAX];
+
+static double bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* XBM rows are LSB-first; clipped like canvas_draw_xbm() */
+static void bench_blit(int x, int y, const uint8_t* bits) {
+    for(int row=0; row<ENTITY_SPRITE_H; row++) {
+        int py = y + row;
+        if(py < 0 || py >= BENCH_SCREEN_H) continue;
+        for(int col=0; col<ENTITY_SPRITE_W; col++) {
+            int px = x + col;
+            if(px < 0 || px >= ENTITY_SCREEN_W || !(bits[row] & (1 << col))) continue;
+            frame_buffer[py * (ENTITY_SCREEN_W / 8) + px / 8] |= 1 << (px & 7);
+        }
+    }
+}
+
+/* Mean host ns per frame for a pool of count entities at a frame interval */
+static double bench_run(const BenchConfig* cfg, const RarityTable* rarity, uint16_t count, uint32_t interval) {
+    static EntityPool pool;
+    pool.seed = 0x5EED0000u + count;
+    entity_pool_spawn(&pool, rarity, cfg->world, count, 0);
+    uint32_t now = 0;
+    uint64_t drawn = 0;
+    double start = bench_now_ns();
+    for(uint32_t f=0; f<cfg->frames; f++) {
+        now += interval;
+        entity_pool_update(&pool, rarity, now);
+        uint16_t n = entity_pool_visible(&pool, now, sprites);
+        memset(frame_buffer, 0, sizeof(frame_buffer));
+        for(int i=0; i<n; i++) bench_blit(sprites[i].x, sprites[i].y, sprites[i].bits);
+        drawn += n;
+    }
+    double elapsed = bench_now_ns() - start;
+    /* Keep the blits observable so the loop is not optimized away */
+    if(drawn == 0 && frame_buffer[0] == 0xFF) puts("");
+    return elapsed / cfg->frames;
+}
+
+static void bench_usage(const char* argv0) {
+    fprintf(stderr, "usage: %s [-f frames] [-b budget_pct] [-x slowdown] [-w world]\n", argv0);
+}
+
+int main(int argc, char** argv) {
+    BenchConfig cfg = {.frames = 2000, .budget_pct = 20, .slowdown = 50.0, .world = 0};
+    int opt;
+    while((opt = getopt(argc, argv, "f:b:x:w:h")) != -1) {
+        switch(opt) {
+        case 'f': cfg.frames = strtoul(optarg, NULL, 0); break;
+        case 'b': cfg.budget_pct = strtoul(optarg, NULL, 0); break;
+        case 'x': cfg.slowdown = strtod(optarg, NULL); break;
+        case 'w': cfg.world = atoi(optarg); break;
+        default: bench_usage(argv[0]); return 2;
+        }
+    }
+    if(cfg.frames == 0) cfg.frames = 1;
+    if(cfg.budget_pct == 0 || cfg.budget_pct > 100) cfg.budget_pct = 100;
+
+    content_load(NULL);
+    if(cfg.world < 0 || cfg.world >= content_world_count()) cfg.world = 0;
+    RarityTable rarity;
+    rarity_table_build(&rarity, 1, content_world(cfg.world)->depth);
+
+    static const uint32_t rates[BENCH_MAX_RATES] = {BENCH_TICK_MS, BENCH_FAST_MS};
+    uint16_t best[BENCH_MAX_RATES] = {0};
+    printf("entities,interval_ms,host_ns,device_us_est,budget_us\n");
+    for(uint32_t count=1; count<=ENTITY_MAX; count*=2) {
+        for(int r=0; r<BENCH_MAX_RATES; r++) {
+            double host_ns = bench_run(&cfg, &rarity, count, rates[r]);
+            double device_us = host_ns * cfg.slowdown / 1000.0;
+            double budget_us = rates[r] * 1000.0 * cfg.budget_pct / 100.0;
+            printf("%u,%lu,%.0f,%.1f,%.0f\n", count, (unsigned long)rates[r], host_ns, device_us, budget_us);
+            if(device_us <= budget_us && best[r] == count / 2) best[r] = count;
+        }
+    }
+    for(int r=0; r<BENCH_MAX_RATES; r++) {
+        fprintf(stderr, "%lu ms frames: up to %u entities in %u%% of the frame (x%.0f slowdown, pool max %d)\n",
+            (unsigned long)rates[r], best[r], cfg.budget_pct, cfg.slowdown, ENTITY_MAX);
+    }
+    return 0;
+}
@@ -0,0 +1,118 @@
+/*
+ * Host tests for the packets in the water.
+ *
+ *  - Determinism: for a given seed the pool ends up in the same state
+ *    whether it is updated every 7 ms, every second or once, and a
+ *    different seed gives different water.
+ *  - Bite tiers: bites taken the way the game takes them (nearest packet
+ *    to the hook, hooked, released when reeled in) must come up in each
+ *    tier as often as the rarity weights say, within five standard
+ *    deviations, for a spread of antenna levels and world depths.
+ *
+ * Built and run by `make test` in this directory; -n sets the bites per case.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "cyber_fishing_content.h"
+#include "cyber_fishing_entity.h"
+#include "host_test.h"
+
+#define ENTITY_TEST_SPAN_MS (10 * 60 * 1000)
+
+static void entity_run(EntityPool* pool, const RarityTable* rarity, uint32_t seed, uint32_t step_ms) {
+    memset(pool, 0, sizeof(EntityPool));
+    pool->seed = seed;
+    entity_pool_spawn(pool, rarity, 0, ENTITY_MAX, 0);
+    for(uint32_t t=step_ms; t<ENTITY_TEST_SPAN_MS; t+=step_ms) entity_pool_update(pool, rarity, t);
+    entity_pool_update(pool, rarity, ENTITY_TEST_SPAN_MS);
+}
+
+static void test_determinism(void) {
+    RarityTable rarity;
+    rarity_table_build(&rarity, 10, 2);
+    const uint32_t seeds[] = {0x2545F491u, 0x9E3779B9u, 0x7F4A7C15u};
+    static EntityPool a, b, c, other;
+    for(size_t s=0; s<sizeof(seeds) / sizeof(seeds[0]); s++) {
+        entity_run(&a, &rarity, seeds[s], 7);
+        entity_run(&b, &rarity, seeds[s], 1000);
+        entity_run(&c, &rarity, seeds[s], ENTITY_TEST_SPAN_MS);
+        CHECK(memcmp(&a, &b, sizeof(EntityPool)) == 0);
+        CHECK(memcmp(&a, &c, sizeof(EntityPool)) == 0);
+        /* Packets have crossed the screen many times over */
+        CHECK(a.gen[0] > 10);
+        entity_run(&other, &rarity, seeds[s] + 1, 1000);
+        CHECK(memcmp(&a, &other, sizeof(EntityPool)) != 0);
+    }
+}
+
+static double test_bite_tiers(uint32_t antenna, int depth, uint32_t bites) {
+    RarityTable rarity;
+    rarity_table_build(&rarity, antenna, depth);
+    static EntityPool pool;
+    memset(&pool, 0, sizeof(pool));
+    pool.seed = 0x6C8E9CF5u ^ (antenna << 8) ^ depth;
+    entity_pool_spawn(&pool, &rarity, depth, ENTITY_MAX, 0);
+    uint32_t rng = rng_seed_state(0x2545F491u);
+    uint32_t hits[RARITY_TIERS] = {0}, empty = 0, t = 0;
+    for(uint32_t n=0; n<bites; n++) {
+        /* A cast's wait, then a reel-in shortly after the bite */
+        t += 1000 + rng_range(&rng, 4000);
+        entity_pool_update(&pool, &rarity, t);
+        int hooked = entity_pool_nearest(&pool, ENTITY_HOOK_X, t);
+        if(hooked < 0) {
+            empty++;
+            continue;
+        }
+        hits[pool.tier[hooked]]++;
+        entity_pool_hook(&pool, hooked);
+        t += 300;
+        entity_pool_release(&pool, &rarity, t);
+    }
+    /* The game falls back to rarity_sample() on empty water; it should almost never need to */
+    CHECK(empty * 100 < bites);
+    uint32_t taken = bites - empty;
+    double worst = 0;
+    for(int tier=0; tier<RARITY_TIERS; tier++) {
+        double p = rarity.weight[tier] / (double)RARITY_ROLLS;
+        if(p == 0) {
+            CHECK_EQ(hits[tier], 0);
+            continue;
+        }
+        double sd = sqrt(taken * p * (1 - p));
+        double sigma = fabs(hits[tier] - taken * p) / (sd > 0 ? sd : 1);
+        if(sigma > worst) worst = sigma;
+        CHECK(sigma <= 5);
+    }
+    return worst;
+}
+
+int main(int argc, char** argv) {
+    uint32_t bites = 20000;
+    int opt;
+    while((opt = getopt(argc, argv, "n:")) != -1) {
+        if(opt != 'n') {
+            fprintf(stderr, "usage: %s [-n bites]\n", argv[0]);
+            return 2;
+        }
+        bites = strtoul(optarg, NULL, 0);
+    }
+    if(bites == 0) bites = 1;
+
+    content_load(NULL);
+    test_determinism();
+    const uint8_t antennas[] = {0, 5, 20, 60};
+    double worst = 0;
+    for(size_t a=0; a<sizeof(antennas); a++) {
+        for(int depth=0; depth<5; depth++) {
+            double sigma = test_bite_tiers(antennas[a], depth, bites);
+            if(sigma > worst) worst = sigma;
+        }
+    }
+    printf("cases=%lu bites=%lu worst=%.2f sd\n", (unsigned long)sizeof(antennas) * 5, (unsigned long)bites, worst);
+    return host_test_done("entity_test");
+}
@@ -0,0 +1,110 @@
+/*
+ * Host-side benchmark for the event bus and achievement rules.
+ *
+ * Subscribes growing numbers of synthetic rules, spread evenly over the
+ * event types with random filters and counters, then publishes a random
+ * stream of events and reports the mean cost per event and per handler
+ * run. Targets are out of reach, so no rule ever takes the early return
+ * of an unlocked rule and the numbers are the worst case. Steps that
+ * publish nothing never touch the bus.
+ *
+ * Build from the app directory; the rule capacity is a compile-time size:
+ *
+ *   cc -O2 -I. -DACH_WORDS=64 -DEVENT_MAX_SUBSCRIBERS=2100 tools/event_bench.c \
+ *      cyber_fishing_events.c cyber_fishing_achievements.c -o event_bench
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cyber_fishing_achievements.h"
+
+static EventBus bus;
+static AchievementRule rules[ACH_MAX];
+
+static double bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static uint32_t bench_rand(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static void bench_rules(uint16_t count, uint32_t seed) {
+    for(uint16_t i=0; i<count; i++) {
+        AchievementRule* rule = &rules[i];
+        rule->name = "bench";
+        rule->event = i % GameEventTypes;
+        rule->world = bench_rand(&seed) % 2 ? ACH_ANY : (int8_t)(bench_rand(&seed) % 5);
+        rule->subject = bench_rand(&seed) % 2 ? ACH_ANY : (int8_t)(bench_rand(&seed) % 7);
+        rule->counter = bench_rand(&seed) % 2 ? ACH_NO_COUNTER : bench_rand(&seed) % AchCounters;
+        rule->target = UINT32_MAX;
+    }
+}
+
+static void bench_usage(const char* argv0) {
+    fprintf(stderr, "usage: %s [-e events] [-s seed]\n", argv0);
+}
+
+int main(int argc, char** argv) {
+    uint32_t events = 1000000, seed = 1;
+    int opt;
+    while((opt = getopt(argc, argv, "e:s:h")) != -1) {
+        switch(opt) {
+        case 'e': events = strtoul(optarg, NULL, 0); break;
+        case 's': seed = strtoul(optarg, NULL, 0); break;
+        default: bench_usage(argv[0]); return 2;
+        }
+    }
+    if(events == 0) events = 1;
+    if(seed == 0) seed = 1;
+
+    static GameEvent stream[4096];
+    uint32_t rng = seed;
+    for(size_t i=0; i<sizeof(stream) / sizeof(stream[0]); i++) {
+        stream[i] = (GameEvent){
+            .type = bench_rand(&rng) % GameEventTypes,
+            .world = bench_rand(&rng) % 5,
+            .subject = bench_rand(&rng) % 7,
+            .count = 1 + bench_rand(&rng) % 16,
+            .credits = bench_rand(&rng) % 1000,
+        };
+    }
+
+    printf("rules,ns_per_event,handlers_per_event,ns_per_handler\n");
+    for(uint32_t count=16; count<=ACH_MAX; count*=2) {
+        memset(&bus, 0, sizeof(bus));
+        bench_rules(count, seed);
+        if(!achievements_subscribe(&bus, rules, count)) {
+            fprintf(stderr, "bus full at %lu rules; raise EVENT_MAX_SUBSCRIBERS\n", (unsigned long)count);
+            return 1;
+        }
+        AchievementState state;
+        memset(&state, 0, sizeof(state));
+        uint64_t handlers = 0;
+        for(int t=0; t<GameEventTypes; t++) {
+            uint32_t chain = 0;
+            for(uint16_t id = bus.head[t]; id; id = bus.next[id - 1]) chain++;
+            handlers += chain;
+        }
+        uint32_t unlocked = 0;
+        double start = bench_now_ns();
+        for(uint32_t i=0; i<events; i++) unlocked += event_publish(&bus, &state, &stream[i & 4095]);
+        double elapsed = bench_now_ns() - start;
+        double per_event = elapsed / events;
+        /* Types are uniform in the stream, so a publish walks the mean chain */
+        double chain = (double)handlers / GameEventTypes;
+        printf("%lu,%.1f,%.1f,%.2f\n", (unsigned long)count, per_event, chain, per_event / chain);
+        if(unlocked) fprintf(stderr, "unexpected unlocks: %lu\n", (unsigned long)unlocked);
+    }
+    return 0;
+}
@@ -0,0 +1,529 @@
+/*
+ * Host tests for the game core, driven through game_step() the way the
+ * main loop drives it: timed wakeups with no input, and inputs stamped
+ * with the time they happened. Checks that how often the loop wakes does
+ * not change the outcome, and ends with saves written to and loaded back
+ * from the storage stand-in, and the catch counters likewise.
+ *
+ * Built and run by `make test` in this directory.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <furi.h>
+#include <storage/storage.h>
+
+#include "cyber_fishing_game.h"
+#include "cyber_fishing_history.h"
+#include "cyber_fishing_save.h"
+#include "host_test.h"
+
+static uint32_t test_press(CyberFishApp* app, GameKey key, uint32_t time) {
+    GameInput input = {.key = key, .type = GameInputShort, .time = time};
+    return game_step(app, &input, time);
+}
+
+static uint32_t test_long(CyberFishApp* app, GameKey key, uint32_t time) {
+    GameInput input = {.key = key, .type = GameInputLong, .time = time};
+    return game_step(app, &input, time);
+}
+
+static void test_splash(void) {
+    CyberFishApp* app = host_app_new(1);
+    CHECK_EQ(app->ui.current_state, StateSplash);
+    CHECK_EQ(game_timeout(app, 0), GAME_SPLASH_MS);
+    game_step(app, NULL, GAME_SPLASH_MS - 1);
+    CHECK_EQ(app->ui.current_state, StateSplash);
+    CHECK_EQ(game_timeout(app, GAME_SPLASH_MS - 1), 1);
+    game_step(app, NULL, GAME_SPLASH_MS);
+    CHECK_EQ(app->ui.current_state, StateWaiting);
+    CHECK_EQ(game_timeout(app, GAME_SPLASH_MS), GAME_NO_DEADLINE);
+    CHECK(test_press(app, GameKeyBack, GAME_SPLASH_MS + 10) & GameEffectExit);
+    free(app);
+}
+
+/* Casts and steps to the bite; returns the time it bit */
+static uint32_t test_cast_to_bite(CyberFishApp* app, uint32_t now) {
+    test_press(app, GameKeyOk, now);
+    CHECK_EQ(app->ui.current_state, StateFishing);
+    uint32_t wait = app->ui.deadline - now;
+    CHECK(wait >= GAME_TICK_MS);
+    CHECK(wait < GAME_CAST_SPREAD_MS + (uint32_t)abs(game_cast_base_ms(app)) + GAME_TICK_MS);
+    uint32_t bite = app->ui.deadline;
+    CHECK_EQ(game_step(app, NULL, bite - 1) & GameEffectBite, 0);
+    CHECK(game_step(app, NULL, bite) & GameEffectBite);
+    CHECK_EQ(app->ui.current_state, StateBite);
+    CHECK_EQ(app->ui.bite_at, bite);
+    return bite;
+}
+
+static void test_catch(void) {
+    CyberFishApp* app = host_app_new(2);
+    game_step(app, NULL, GAME_SPLASH_MS);
+    uint32_t bite = test_cast_to_bite(app, GAME_SPLASH_MS + 500);
+    uint32_t fx = test_press(app, GameKeyOk, bite + 300);
+    CHECK(fx & GameEffectCatch);
+    CHECK(fx & GameEffectSave);
+    /* The first catch unlocks "First Contact" */
+    CHECK(fx & GameEffectAchievement);
+    CHECK(achievement_unlocked(&app->progress.achievements, 0));
+    CHECK_EQ(app->ui.current_state, StateCaught);
+    CHECK_EQ(app->progress.inv_used, 1);
+    CHECK_EQ(app->progress.inv[0].pkt, app->ui.bite_pkt);
+    CHECK_EQ(app->progress.inv[0].count, 1);
+    CHECK(game_discovered(app, app->ui.bite_pkt));
+    CHECK_EQ(app->ui.discovered_count, 1);
+
+    /* Back to the water, then sell it at the Market */
+    test_press(app, GameKeyOk, bite + 1000);
+    CHECK_EQ(app->ui.current_state, StateWaiting);
+    uint32_t price = game_price(app->progress.inv[0].pkt, 1);
+    test_press(app, GameKeyDown, bite + 1500);
+    CHECK_EQ(app->ui.current_state, StateSell);
+    CHECK_EQ(game_frame_interval(app), 0);
+    CHECK(test_press(app, GameKeyOk, bite + 2000) & GameEffectSave);
+    CHECK_EQ(app->progress.credits, price);
+    CHECK_EQ(app->progress.inv_used, 0);
+    free(app);
+}
+
+static void test_miss(void) {
+    CyberFishApp* app = host_app_new(3);
+    game_step(app, NULL, GAME_SPLASH_MS);
+    test_cast_to_bite(app, GAME_SPLASH_MS);
+    uint32_t closes = app->ui.deadline;
+    CHECK(game_step(app, NULL, closes) & GameEffectFail);
+    CHECK_EQ(app->ui.current_state, StateLost);
+    /* A late reel-in is the miss itself and does not dismiss LOST PKT */
+    test_press(app, GameKeyOk, closes + GAME_LOST_HOLD_MS - 1);
+    CHECK_EQ(app->ui.current_state, StateLost);
+    test_press(app, GameKeyOk, closes + GAME_LOST_HOLD_MS);
+    CHECK_EQ(app->ui.current_state, StateWaiting);
+    CHECK_EQ(app->progress.inv_used, 0);
+    free(app);
+}
+
+/* Hold OK sells the stack under the cursor, hold RIGHT sells the whole hold */
+static void test_sell_bulk(void) {
+    CyberFishApp* app = host_app_new(9);
+    CyberFishProgress* pr = &app->progress;
+    game_step(app, NULL, GAME_SPLASH_MS);
+    const InvStack stacks[] = {{0, 10}, {3, 4}, {6, 2}};
+    pr->inv_used = 3;
+    memcpy(pr->inv, stacks, sizeof(stacks));
+    uint32_t now = GAME_SPLASH_MS + 100;
+    test_press(app, GameKeyDown, now);
+    CHECK_EQ(app->ui.current_state, StateSell);
+    test_press(app, GameKeyDown, now += 100);
+    test_press(app, GameKeyDown, now += 100);
+    CHECK_EQ(app->ui.shop_cursor, 2);
+
+    /* Selling the last stack pulls the cursor back onto the hold */
+    CHECK(test_long(app, GameKeyOk, now += 100) & GameEffectSave);
+    CHECK_EQ(pr->credits, game_price(6, 1) * 2);
+    CHECK_EQ(pr->inv_used, 2);
+    CHECK_EQ(app->ui.shop_cursor, 1);
+    CHECK_EQ(pr->inv[2].count, 0);
+    test_long(app, GameKeyOk, now += 100);
+    CHECK_EQ(pr->credits, game_price(6, 1) * 2 + game_price(3, 1) * 4);
+    CHECK_EQ(pr->inv_used, 1);
+    CHECK_EQ(app->ui.shop_cursor, 0);
+    CHECK_EQ(pr->inv[0].pkt, 0);
+
+    test_long(app, GameKeyRight, now += 100);
+    CHECK_EQ(pr->credits, game_price(6, 1) * 2 + game_price(3, 1) * 4 + game_price(0, 1) * 10);
+    CHECK_EQ(pr->inv_used, 0);
+    CHECK_EQ(app->ui.shop_cursor, 0);
+    /* An empty hold sells nothing */
+    CHECK_EQ(test_long(app, GameKeyOk, now += 100) & GameEffectSave, 0);
+
+    /* A high core version: the sale is worth more than the balance can hold */
+    const InvStack rich[] = {{6, 1000}, {5, 1000}, {0, 1}};
+    pr->core_ver = UINT16_MAX;
+    pr->credits = 7;
+    pr->inv_used = 3;
+    memcpy(pr->inv, rich, sizeof(rich));
+    CHECK((uint64_t)game_price(6, pr->core_ver) * 1000 > UINT32_MAX);
+    test_long(app, GameKeyRight, now += 100);
+    CHECK_EQ(pr->credits, UINT32_MAX);
+    CHECK_EQ(pr->inv_used, 0);
+    CHECK_EQ(pr->inv[0].count, 0);
+    free(app);
+}
+
+/* A fresh app at antenna 0 in world 0 must not take its zeroed table for a built one */
+static void test_fresh_rarity(void) {
+    CyberFishApp* app = host_app_new(7);
+    app->progress.antenna_lvl = 0;
+    game_sync_rarity(app);
+    uint32_t total = 0;
+    for(int t=0; t<RARITY_TIERS; t++) total += app->rarity.weight[t];
+    CHECK_EQ(total, RARITY_ROLLS);
+    free(app);
+}
+
+static void test_shop(void) {
+    CyberFishApp* app = host_app_new(4);
+    game_step(app, NULL, GAME_SPLASH_MS);
+    test_press(app, GameKeyUp, GAME_SPLASH_MS + 100);
+    CHECK_EQ(app->ui.current_state, StateShop);
+    /* Too poor: nothing changes hands */
+    test_press(app, GameKeyOk, GAME_SPLASH_MS + 200);
+    CHECK_EQ(app->progress.buffer_lvl, 1);
+    app->progress.credits = SHOP_BUFFER_COST;
+    test_press(app, GameKeyOk, GAME_SPLASH_MS + 300);
+    CHECK_EQ(app->progress.buffer_lvl, 2);
+    CHECK_EQ(app->progress.credits, 0);
+    test_press(app, GameKeyBack, GAME_SPLASH_MS + 400);
+    CHECK_EQ(app->ui.current_state, StateWaiting);
+    free(app);
+}
+
+#define STEP_RATE_END_MS 200000
+#define STEP_RATE_INPUTS 160
+
+/* Casts and reels on a fixed beat; every tenth beat also sells one at the Market */
+static uint32_t step_rate_script(GameInput* inputs) {
+    uint32_t n = 0, t = GAME_SPLASH_MS + 500;
+    for(uint32_t beat=0; n + 4 <= STEP_RATE_INPUTS && t < STEP_RATE_END_MS; beat++) {
+        if(beat % 10 == 9) {
+            const GameKey sell[] = {GameKeyDown, GameKeyOk, GameKeyBack};
+            for(int k=0; k<3; k++) inputs[n++] = (GameInput){.key = sell[k], .type = GameInputShort, .time = t + k * 200};
+        }
+        inputs[n++] = (GameInput){.key = GameKeyOk, .type = GameInputShort, .time = t + 700};
+        t += 1700;
+    }
+    return n;
+}
+
+/*
+ * Wakes every step_ms with no input, the way a frame timer would. Inputs
+ * that land inside a step are stepped in order, each up to the next one's
+ * time, as the loop does when it wakes once per captured input.
+ */
+static CyberFishApp* step_rate_run(uint32_t seed, uint32_t step_ms, const GameInput* inputs, uint32_t count) {
+    CyberFishApp* app = host_app_new(seed);
+    uint32_t next = 0;
+    for(uint32_t t=0; t<STEP_RATE_END_MS;) {
+        t = STEP_RATE_END_MS - t > step_ms ? t + step_ms : STEP_RATE_END_MS;
+        while(next < count && inputs[next].time <= t) {
+            uint32_t until = next + 1 < count && inputs[next + 1].time <= t ? inputs[next + 1].time : t;
+            game_step(app, &inputs[next++], until);
+        }
+        game_step(app, NULL, t);
+    }
+    return app;
+}
+
+static void test_step_rate(void) {
+    static GameInput inputs[STEP_RATE_INPUTS];
+    uint32_t count = step_rate_script(inputs);
+    const uint32_t steps[] = {100, 1000000};
+    for(uint32_t seed=1; seed<=8; seed++) {
+        CyberFishApp* ref = step_rate_run(seed, 7, inputs, count);
+        CHECK(ref->progress.achievements.counters[AchCounterCaught] > 0);
+        CHECK(ref->progress.achievements.counters[AchCounterSold] > 0);
+        for(size_t i=0; i<sizeof(steps) / sizeof(steps[0]); i++) {
+            CyberFishApp* app = step_rate_run(seed, steps[i], inputs, count);
+            CHECK_EQ(app->rng_state, ref->rng_state);
+            CHECK_EQ(app->ui.current_state, ref->ui.current_state);
+            CHECK(memcmp(&app->progress, &ref->progress, sizeof(CyberFishProgress)) == 0);
+            CHECK(memcmp(&app->fish, &ref->fish, sizeof(EntityPool)) == 0);
+            free(app);
+        }
+        free(ref);
+    }
+}
+
+static void test_save_round_trip(void) {
+    CyberFishApp* app = host_app_new(5);
+    game_step(app, NULL, GAME_SPLASH_MS);
+    uint32_t now = GAME_SPLASH_MS;
+    for(int i=0; i<5; i++) {
+        uint32_t bite = test_cast_to_bite(app, now + 100);
+        test_press(app, GameKeyOk, bite + 200);
+        test_press(app, GameKeyOk, bite + 400);
+        now = bite + 400;
+    }
+    SaveEngine engine;
+    save_engine_init(&engine);
+    save_mark_dirty(&engine, now);
+    save_flush(&engine, app);
+    CHECK_EQ(engine.writes, 1);
+
+    CyberFishApp* loaded = host_app_new(1);
+    load_game(loaded);
+    /* saved_at is stamped by the flush, everything else must match */
+    loaded->progress.saved_at = app->progress.saved_at;
+    CHECK(memcmp(&loaded->progress, &app->progress, sizeof(CyberFishProgress)) == 0);
+    CHECK_EQ(loaded->ui.discovered_count, app->ui.discovered_count);
+    free(loaded);
+    free(app);
+}
+
+#define TEST_SAVE_PATH EXT_PATH("apps_data/cyber_fishing.save")
+#define TEST_SAVE_TMP_PATH EXT_PATH("apps_data/cyber_fishing.save.tmp")
+
+/* Writes len bytes to path as the whole file; len 0 removes it */
+static void test_write_file(const char* path, const uint8_t* data, size_t len) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    storage_common_mkdir(storage, EXT_PATH("apps_data"));
+    if(len == 0) {
+        storage_common_remove(storage, path);
+    } else {
+        File* file = storage_file_alloc(storage);
+        CHECK(storage_file_open(file, path, FSAM_WRITE, FSOM_CREATE_ALWAYS));
+        CHECK_EQ(storage_file_write(file, data, len), len);
+        storage_file_close(file);
+        storage_file_free(file);
+    }
+    furi_record_close(RECORD_STORAGE);
+}
+
+/* Loads whatever is on the card into a new app; the caller frees it */
+static CyberFishApp* test_load(void) {
+    CyberFishApp* loaded = host_app_new(1);
+    load_game(loaded);
+    return loaded;
+}
+
+/* A damaged save loads as a new player, unless a valid temp file survives beside it */
+static void test_save_torn(void) {
+    CyberFishApp* app = host_app_new(8);
+    app->progress.credits = 12345;
+    app->progress.buffer_lvl = 3;
+    uint8_t good[SAVE_IMAGE_MAX], bad[SAVE_IMAGE_MAX];
+    size_t len = save_encode(app, good);
+    test_write_file(TEST_SAVE_TMP_PATH, NULL, 0);
+
+    /* Cut short, as by pulling the card mid-write */
+    test_write_file(TEST_SAVE_PATH, good, len - 1);
+    CyberFishApp* loaded = test_load();
+    CHECK_EQ(loaded->progress.credits, 0);
+    CHECK_EQ(loaded->progress.buffer_lvl, 1);
+    free(loaded);
+
+    /* One payload byte flipped fails the CRC */
+    memcpy(bad, good, len);
+    bad[SAVE_HEADER_SIZE + 5] ^= 0x10;
+    test_write_file(TEST_SAVE_PATH, bad, len);
+    loaded = test_load();
+    CHECK_EQ(loaded->progress.credits, 0);
+    free(loaded);
+
+    /* Not a save at all */
+    memcpy(bad, good, len);
+    bad[0] ^= 0xFF;
+    test_write_file(TEST_SAVE_PATH, bad, len);
+    loaded = test_load();
+    CHECK_EQ(loaded->progress.credits, 0);
+    free(loaded);
+
+    /* A version from the future, with a payload CRC that still checks out */
+    memcpy(bad, good, len);
+    bad[4] = SAVE_VERSION + 1;
+    bad[5] = 0;
+    test_write_file(TEST_SAVE_PATH, bad, len);
+    loaded = test_load();
+    CHECK_EQ(loaded->progress.credits, 0);
+    free(loaded);
+
+    /* Torn main file, but the temp file from the same flush was complete */
+    test_write_file(TEST_SAVE_PATH, good, len / 2);
+    test_write_file(TEST_SAVE_TMP_PATH, good, len);
+    loaded = test_load();
+    CHECK_EQ(loaded->progress.credits, 12345);
+    CHECK_EQ(loaded->progress.buffer_lvl, 3);
+    free(loaded);
+
+    test_write_file(TEST_SAVE_PATH, NULL, 0);
+    test_write_file(TEST_SAVE_TMP_PATH, NULL, 0);
+    free(app);
+}
+
+/* A save written against a bigger pack keeps only what the loaded content has */
+static void test_save_out_of_range(void) {
+    uint16_t packets = content_packet_count();
+    CyberFishApp* app = host_app_new(6);
+    CyberFishProgress* pr = &app->progress;
+    const InvStack stacks[] = {{2, 5}, {packets, 9}, {packets + 40, 1}, {2, 3}, {0, 7}};
+    pr->inv_used = sizeof(stacks) / sizeof(stacks[0]);
+    memcpy(pr->inv, stacks, sizeof(stacks));
+    memset(pr->discovered, 0xFF, sizeof(pr->discovered));
+    pr->world_unlocked = 0xFFFF;
+    uint8_t image[SAVE_IMAGE_MAX];
+    size_t len = save_encode(app, image);
+
+    test_write_file(TEST_SAVE_PATH, image, len);
+
+    CyberFishApp* loaded = host_app_new(1);
+    load_game(loaded);
+    CHECK_EQ(loaded->progress.inv_used, 2);
+    CHECK_EQ(loaded->progress.inv[0].pkt, 2);
+    CHECK_EQ(loaded->progress.inv[0].count, 8);
+    CHECK_EQ(loaded->progress.inv[1].pkt, 0);
+    CHECK_EQ(loaded->progress.inv[1].count, 7);
+    CHECK_EQ(loaded->ui.discovered_count, packets);
+    CHECK_EQ(loaded->progress.world_unlocked, (1u << content_world_count()) - 1);
+    free(loaded);
+    free(app);
+}
+
+static uint8_t* test_put_u32(uint8_t* p, uint32_t v) {
+    for(int i=0; i<4; i++) p[i] = v >> (8 * i);
+    return p + 4;
+}
+
+/* The seven leading words and fixed inv[] that v1 and v2 share */
+static uint8_t* test_put_old_words(uint8_t* p, const uint32_t* inv) {
+    const uint32_t words[] = {12345, 999, 3, 40, 2, 2, 3};
+    for(int i=0; i<7; i++) p = test_put_u32(p, words[i]);
+    for(int i=0; i<7; i++) p = test_put_u32(p, inv[i]);
+    return p;
+}
+
+static size_t test_put_header(uint8_t* image, uint16_t version, uint16_t payload) {
+    uint8_t* h = test_put_u32(image, SAVE_MAGIC);
+    h[0] = version; h[1] = version >> 8;
+    h[2] = payload; h[3] = payload >> 8;
+    test_put_u32(h + 4, save_crc32(image + SAVE_HEADER_SIZE, payload));
+    return SAVE_HEADER_SIZE + payload;
+}
+
+/* Saves from every older layout load with the same progress */
+static void test_save_migrate(void) {
+    /* Packets 0, 2 and 6 held and seen, worlds 0-2 open */
+    const uint32_t inv[7] = {5, 0, 7, 0, 0, 0, 2};
+    const uint8_t discovered = 0x45, worlds = 0x07;
+    uint8_t images[3][SAVE_FILE_MAX];
+    size_t lens[3];
+    memset(images, 0, sizeof(images));
+
+    /* v1: headerless, a byte per packet and per world */
+    uint8_t* p = test_put_old_words(images[0], inv);
+    for(int i=0; i<7; i++) *p++ = (discovered >> i) & 1;
+    for(int i=0; i<5; i++) *p++ = (worlds >> i) & 1;
+    lens[0] = p - images[0];
+    CHECK_EQ(lens[0], SAVE_LEGACY_SIZE);
+
+    /* v2: the same words under a header, the flags packed into masks */
+    p = test_put_old_words(images[1] + SAVE_HEADER_SIZE, inv);
+    *p++ = discovered;
+    *p++ = worlds;
+    CHECK_EQ(p - images[1] - SAVE_HEADER_SIZE, SAVE_V2_PAYLOAD_SIZE);
+    lens[1] = test_put_header(images[1], 2, SAVE_V2_PAYLOAD_SIZE);
+
+    /* v3: the packed record, inv[] second and the levels as bytes */
+    p = test_put_u32(images[2] + SAVE_HEADER_SIZE, 12345);
+    p = test_put_u32(p, 999);
+    for(int i=0; i<7; i++) p = test_put_u32(p, inv[i]);
+    *p++ = 3; *p++ = 0;
+    *p++ = 3; *p++ = 40; *p++ = 2; *p++ = 2;
+    *p++ = discovered;
+    *p++ = worlds;
+    lens[2] = test_put_header(images[2], 3, p - images[2] - SAVE_HEADER_SIZE);
+    CHECK_EQ(lens[2], SAVE_HEADER_SIZE + 44);
+
+    test_write_file(TEST_SAVE_TMP_PATH, NULL, 0);
+    for(int v=0; v<3; v++) {
+        test_write_file(TEST_SAVE_PATH, images[v], lens[v]);
+        CyberFishApp* loaded = test_load();
+        const CyberFishProgress* pr = &loaded->progress;
+        CHECK_EQ(pr->credits, 12345);
+        CHECK_EQ(pr->high_score, 999);
+        CHECK_EQ(pr->buffer_lvl, 3);
+        CHECK_EQ(pr->antenna_lvl, 40);
+        CHECK_EQ(pr->lure_lvl, 2);
+        CHECK_EQ(pr->current_world, 2);
+        CHECK_EQ(pr->core_ver, 3);
+        CHECK_EQ(pr->inv_used, 3);
+        CHECK_EQ(pr->inv[0].pkt, 0);
+        CHECK_EQ(pr->inv[0].count, 5);
+        CHECK_EQ(pr->inv[1].pkt, 2);
+        CHECK_EQ(pr->inv[1].count, 7);
+        CHECK_EQ(pr->inv[2].pkt, 6);
+        CHECK_EQ(pr->inv[2].count, 2);
+        CHECK_EQ(pr->discovered[0], discovered);
+        CHECK_EQ(loaded->ui.discovered_count, 3);
+        CHECK_EQ(pr->world_unlocked, worlds);
+
+        /* And it saves back as the current layout with nothing lost */
+        uint8_t image[SAVE_IMAGE_MAX];
+        CyberFishProgress again;
+        CHECK(save_decode(&again, image, save_encode(loaded, image)));
+        CHECK(memcmp(&again, pr, sizeof(again)) == 0);
+        free(loaded);
+    }
+    test_write_file(TEST_SAVE_PATH, NULL, 0);
+}
+
+/* The counters go through a temp file, also on firmware that will not rename over a file */
+static void test_history_stats(void) {
+    const bool no_replace[] = {false, true};
+    for(int i=0; i<2; i++) {
+        storage_host_rename_no_replace = no_replace[i];
+        static CatchHistory hist;
+        history_init(&hist);
+        uint32_t bites = hist.stats.bites[1];
+        uint32_t renames = storage_host_stats.renames;
+        history_bite(&hist, 1);
+        history_bite(&hist, 1);
+        history_close(&hist);
+        CHECK(!hist.stats_dirty);
+        CHECK(storage_host_stats.renames > renames);
+        CHECK(access(storage_host_path(EXT_PATH("apps_data/cyber_fishing.stats.tmp")), F_OK) != 0);
+        history_init(&hist);
+        CHECK_EQ(hist.stats.bites[1], bites + 2);
+    }
+    storage_host_rename_no_replace = false;
+}
+
+/* A compaction that fails leaves the log and its count alone, and the next poll tries again */
+static void test_history_compact_retry(void) {
+    static CatchHistory hist;
+    history_init(&hist);
+    const HistoryCatch rec = {.time = 1, .price = 5, .reaction_ms = 200, .world = 0};
+    for(int i=0; i<HISTORY_BATCH; i++) history_add(&hist, &rec, 1000 + i);
+    history_poll(&hist);
+    CHECK_EQ(hist.head, hist.tail);
+    hist.stats.log_catches = HISTORY_LOG_MAX;
+
+    /* A directory where the rewrite goes makes the compaction fail */
+    const char* tmp = storage_host_path(EXT_PATH("apps_data/cyber_fishing.hist.tmp"));
+    CHECK(mkdir(tmp, 0755) == 0);
+    history_poll(&hist);
+    CHECK(hist.compactor != NULL);
+    while(furi_thread_get_state(hist.compactor) != FuriThreadStateStopped) furi_delay_ms(1);
+    history_poll(&hist);
+    CHECK_EQ(hist.stats.log_catches, HISTORY_LOG_MAX);
+    CHECK(hist.compactor != NULL);
+
+    rmdir(tmp);
+    while(hist.compactor && furi_thread_get_state(hist.compactor) != FuriThreadStateStopped) furi_delay_ms(1);
+    history_poll(&hist);
+    history_close(&hist);
+    /* Every catch in the log was older than the newest HISTORY_LOG_KEEP the count claimed */
+    CHECK_EQ(hist.stats.log_catches, 0);
+}
+
+int main(void) {
+    content_load(NULL);
+    game_events_init();
+    test_splash();
+    test_catch();
+    test_miss();
+    test_fresh_rarity();
+    test_shop();
+    test_sell_bulk();
+    test_step_rate();
+    test_save_round_trip();
+    test_save_torn();
+    test_save_out_of_range();
+    test_save_migrate();
+    test_history_stats();
+    test_history_compact_retry();
+    return host_test_done("game_test");
+}
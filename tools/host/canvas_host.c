@@ -0,0 +1,143 @@
+#include <gui/canvas.h>
+
+#include <string.h>
+
+static void canvas_record(Canvas* canvas, CanvasCallKind kind, int32_t x, int32_t y, int32_t a, int32_t b) {
+    if(canvas->count < CANVAS_HOST_CALLS) {
+        canvas->calls[canvas->count] = (CanvasCall){.kind = kind, .x = x, .y = y, .a = a, .b = b};
+    }
+    canvas->count++;
+}
+
+static void canvas_pixel(Canvas* canvas, int32_t x, int32_t y) {
+    if(x < 0 || y < 0 || x >= CANVAS_HOST_W || y >= CANVAS_HOST_H) return;
+    uint8_t* px = &canvas->fb[y][x];
+    if(canvas->color == ColorXOR) *px ^= 1;
+    else *px = canvas->color == ColorBlack;
+}
+
+/* u8g2_DrawLine: step along the major axis, carrying half its length as the error */
+static void canvas_line(Canvas* canvas, int32_t x1, int32_t y1, int32_t x2, int32_t y2) {
+    int32_t dx = x1 > x2 ? x1 - x2 : x2 - x1;
+    int32_t dy = y1 > y2 ? y1 - y2 : y2 - y1;
+    bool steep = dy > dx;
+    if(steep) {
+        int32_t t;
+        t = x1, x1 = y1, y1 = t;
+        t = x2, x2 = y2, y2 = t;
+        t = dx, dx = dy, dy = t;
+    }
+    if(x1 > x2) {
+        int32_t t;
+        t = x1, x1 = x2, x2 = t;
+        t = y1, y1 = y2, y2 = t;
+    }
+    int32_t err = dx >> 1;
+    int32_t step = y2 > y1 ? 1 : -1;
+    for(int32_t x = x1, y = y1; x <= x2; x++) {
+        canvas_pixel(canvas, steep ? y : x, steep ? x : y);
+        err -= dy;
+        if(err < 0) {
+            y += step;
+            err += dx;
+        }
+    }
+}
+
+void canvas_host_reset(Canvas* canvas) {
+    memset(canvas, 0, sizeof(Canvas));
+    canvas->color = ColorBlack;
+}
+
+size_t canvas_host_draw_calls(const Canvas* canvas) {
+    size_t calls = 0;
+    size_t logged = canvas->count < CANVAS_HOST_CALLS ? canvas->count : CANVAS_HOST_CALLS;
+    for(size_t i = 0; i < logged; i++) calls += canvas->calls[i].kind != CanvasCallClear;
+    return calls + (canvas->count - logged);
+}
+
+void canvas_clear(Canvas* canvas) {
+    memset(canvas->fb, 0, sizeof(canvas->fb));
+    canvas_record(canvas, CanvasCallClear, 0, 0, 0, 0);
+}
+
+void canvas_set_color(Canvas* canvas, Color color) {
+    canvas->color = color;
+}
+
+void canvas_set_font(Canvas* canvas, Font font) {
+    canvas->font = font;
+}
+
+void canvas_draw_dot(Canvas* canvas, int32_t x, int32_t y) {
+    canvas_record(canvas, CanvasCallDot, x, y, 0, 0);
+    canvas_pixel(canvas, x, y);
+}
+
+void canvas_draw_line(Canvas* canvas, int32_t x1, int32_t y1, int32_t x2, int32_t y2) {
+    canvas_record(canvas, CanvasCallLine, x1, y1, x2, y2);
+    canvas_line(canvas, x1, y1, x2, y2);
+}
+
+void canvas_draw_frame(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height) {
+    canvas_record(canvas, CanvasCallFrame, x, y, width, height);
+    if(!width || !height) return;
+    int32_t x2 = x + (int32_t)width - 1, y2 = y + (int32_t)height - 1;
+    canvas_line(canvas, x, y, x2, y);
+    canvas_line(canvas, x, y2, x2, y2);
+    /* Sides without the corners, so XOR frames match u8g2_DrawFrame */
+    if(height > 2) {
+        canvas_line(canvas, x, y + 1, x, y2 - 1);
+        if(width > 1) canvas_line(canvas, x2, y + 1, x2, y2 - 1);
+    }
+}
+
+void canvas_draw_box(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height) {
+    canvas_record(canvas, CanvasCallBox, x, y, width, height);
+    for(size_t row = 0; row < height; row++) {
+        for(size_t col = 0; col < width; col++) canvas_pixel(canvas, x + (int32_t)col, y + (int32_t)row);
+    }
+}
+
+/* u8g2_DrawCircle: midpoint circle, one octant mirrored eight ways */
+void canvas_draw_circle(Canvas* canvas, int32_t x0, int32_t y0, size_t radius) {
+    canvas_record(canvas, CanvasCallCircle, x0, y0, radius, 0);
+    int32_t f = 1 - (int32_t)radius, ddf_x = 1, ddf_y = -2 * (int32_t)radius;
+    int32_t x = 0, y = (int32_t)radius;
+    for(;;) {
+        int32_t px[8] = {x0 + x, x0 + y, x0 - x, x0 - y, x0 + x, x0 + y, x0 - x, x0 - y};
+        int32_t py[8] = {y0 - y, y0 - x, y0 - y, y0 - x, y0 + y, y0 + x, y0 + y, y0 + x};
+        for(int i = 0; i < 8; i++) canvas_pixel(canvas, px[i], py[i]);
+        if(x >= y) break;
+        if(f >= 0) {
+            y--;
+            ddf_y += 2;
+            f += ddf_y;
+        }
+        x++;
+        ddf_x += 2;
+        f += ddf_x;
+    }
+}
+
+void canvas_draw_xbm(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height, const uint8_t* bitmap) {
+    canvas_record(canvas, CanvasCallXbm, x, y, width, height);
+    size_t stride = (width + 7) / 8;
+    for(size_t row = 0; row < height; row++) {
+        for(size_t col = 0; col < width; col++) {
+            if(bitmap[row * stride + col / 8] & (1 << (col & 7))) {
+                canvas_pixel(canvas, x + (int32_t)col, y + (int32_t)row);
+            }
+        }
+    }
+}
+
+void canvas_draw_str(Canvas* canvas, int32_t x, int32_t y, const char* str) {
+    canvas_record(canvas, CanvasCallStr, x, y, str ? (int32_t)strlen(str) : 0, 0);
+}
+
+void canvas_draw_str_aligned(Canvas* canvas, int32_t x, int32_t y, Align horizontal, Align vertical, const char* str) {
+    (void)horizontal;
+    (void)vertical;
+    canvas_draw_str(canvas, x, y, str);
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+/*
+ * Host stand-in for the slice of the furi API the app uses, on top of
+ * pthreads. Threads, thread flags and mutexes behave like the firmware's;
+ * furi_get_tick() is a millisecond monotonic clock. Nothing here is built
+ * into the .fap, only into the tools/ host targets.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define FuriWaitForever 0xFFFFFFFFU
+
+typedef enum {
+    FuriFlagWaitAny = 0x00000000U,
+    FuriFlagWaitAll = 0x00000001U,
+    FuriFlagNoClear = 0x00000002U,
+    FuriFlagError = 0x80000000U,
+    FuriFlagErrorUnknown = 0xFFFFFFFFU,
+    FuriFlagErrorTimeout = 0xFFFFFFFEU,
+    FuriFlagErrorResource = 0xFFFFFFFDU,
+    FuriFlagErrorParameter = 0xFFFFFFFCU,
+} FuriFlag;
+
+typedef enum {
+    FuriStatusOk = 0,
+    FuriStatusError = -1,
+    FuriStatusErrorTimeout = -2,
+    FuriStatusErrorResource = -3,
+} FuriStatus;
+
+#define furi_assert(x) ((void)0)
+#define furi_check(x)                                                   \
+    do {                                                                \
+        if(!(x)) {                                                      \
+            fprintf(stderr, "furi_check failed: %s:%d\n", __FILE__, __LINE__); \
+            abort();                                                    \
+        }                                                               \
+    } while(0)
+
+#define FURI_LOG_E(tag, fmt, ...) fprintf(stderr, "[E][%s] " fmt "\n", tag, ##__VA_ARGS__)
+#define FURI_LOG_W(tag, fmt, ...) fprintf(stderr, "[W][%s] " fmt "\n", tag, ##__VA_ARGS__)
+#define FURI_LOG_I(tag, fmt, ...) fprintf(stderr, "[I][%s] " fmt "\n", tag, ##__VA_ARGS__)
+#define FURI_LOG_D(tag, fmt, ...) ((void)0)
+
+uint32_t furi_get_tick(void);
+void furi_delay_ms(uint32_t ms);
+
+/* Records are opaque handles; every name opens the same dummy record */
+void* furi_record_open(const char* name);
+void furi_record_close(const char* name);
+
+typedef enum {
+    FuriThreadStateStopped,
+    FuriThreadStateStarting,
+    FuriThreadStateRunning,
+} FuriThreadState;
+
+typedef struct FuriThread FuriThread;
+typedef struct FuriThreadHost* FuriThreadId;
+typedef int32_t (*FuriThreadCallback)(void* context);
+
+FuriThread* furi_thread_alloc_ex(const char* name, uint32_t stack_size, FuriThreadCallback callback, void* context);
+void furi_thread_free(FuriThread* thread);
+void furi_thread_start(FuriThread* thread);
+bool furi_thread_join(FuriThread* thread);
+FuriThreadState furi_thread_get_state(FuriThread* thread);
+FuriThreadId furi_thread_get_id(FuriThread* thread);
+int32_t furi_thread_get_return_code(FuriThread* thread);
+/* The host has no stack watermark; this is the whole configured stack */
+uint32_t furi_thread_get_stack_space(FuriThreadId thread_id);
+
+FuriThreadId furi_thread_get_current_id(void);
+uint32_t furi_thread_flags_set(FuriThreadId thread_id, uint32_t flags);
+uint32_t furi_thread_flags_clear(uint32_t flags);
+uint32_t furi_thread_flags_get(void);
+uint32_t furi_thread_flags_wait(uint32_t flags, uint32_t options, uint32_t timeout);
+
+typedef enum {
+    FuriMutexTypeNormal,
+    FuriMutexTypeRecursive,
+} FuriMutexType;
+
+typedef struct FuriMutex FuriMutex;
+
+FuriMutex* furi_mutex_alloc(FuriMutexType type);
+void furi_mutex_free(FuriMutex* mutex);
+FuriStatus furi_mutex_acquire(FuriMutex* mutex, uint32_t timeout);
+FuriStatus furi_mutex_release(FuriMutex* mutex);
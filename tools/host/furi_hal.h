@@ -0,0 +1,23 @@
+#pragma once
+
+/*
+ * Host stand-in for the furi_hal calls the app makes. The DWT cycle
+ * counter runs off the monotonic clock at one count per nanosecond, and
+ * the RTC can be pinned so saves and offline time are reproducible.
+ */
+
+#include <furi.h>
+
+typedef struct {
+    volatile uint32_t CYCCNT;
+} FuriHalHostDwt;
+
+FuriHalHostDwt* furi_hal_host_dwt(void);
+#define DWT (furi_hal_host_dwt())
+
+uint32_t furi_hal_cortex_instructions_per_microsecond(void);
+uint32_t furi_hal_random_get(void);
+
+/* Pinned value when furi_hal_host_rtc is nonzero, wall time otherwise */
+extern uint32_t furi_hal_host_rtc;
+uint32_t furi_hal_rtc_get_timestamp(void);
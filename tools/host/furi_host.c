@@ -0,0 +1,246 @@
+#include <furi.h>
+#include <furi_hal.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+
+struct FuriThreadHost {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t flags;
+};
+
+struct FuriThread {
+    struct FuriThreadHost host;
+    pthread_t pthread;
+    const char* name;
+    uint32_t stack_size;
+    FuriThreadCallback callback;
+    void* context;
+    int32_t ret;
+    FuriThreadState state; /* Written under host.lock */
+};
+
+struct FuriMutex {
+    pthread_mutex_t lock;
+};
+
+static __thread struct FuriThreadHost* current_thread;
+static int record_dummy;
+
+static uint64_t host_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/* pthread timed waits take an absolute CLOCK_REALTIME deadline */
+static struct timespec host_deadline(uint32_t timeout_ms) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    uint64_t at = (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec + (uint64_t)timeout_ms * 1000000ull;
+    ts.tv_sec = at / 1000000000ull;
+    ts.tv_nsec = at % 1000000000ull;
+    return ts;
+}
+
+uint32_t furi_get_tick(void) {
+    return (uint32_t)(host_now_ns() / 1000000ull);
+}
+
+void furi_delay_ms(uint32_t ms) {
+    struct timespec ts = {.tv_sec = ms / 1000, .tv_nsec = (long)(ms % 1000) * 1000000L};
+    while(nanosleep(&ts, &ts) && errno == EINTR) {
+    }
+}
+
+void* furi_record_open(const char* name) {
+    (void)name;
+    return &record_dummy;
+}
+
+void furi_record_close(const char* name) {
+    (void)name;
+}
+
+static void host_thread_init(struct FuriThreadHost* host) {
+    pthread_mutex_init(&host->lock, NULL);
+    pthread_cond_init(&host->cond, NULL);
+    host->flags = 0;
+}
+
+FuriThreadId furi_thread_get_current_id(void) {
+    /* Threads not started through furi_thread_start() get a record on first use */
+    if(!current_thread) {
+        current_thread = malloc(sizeof(struct FuriThreadHost));
+        host_thread_init(current_thread);
+    }
+    return current_thread;
+}
+
+FuriThread* furi_thread_alloc_ex(const char* name, uint32_t stack_size, FuriThreadCallback callback, void* context) {
+    FuriThread* thread = calloc(1, sizeof(FuriThread));
+    host_thread_init(&thread->host);
+    thread->name = name;
+    thread->stack_size = stack_size;
+    thread->callback = callback;
+    thread->context = context;
+    thread->state = FuriThreadStateStopped;
+    return thread;
+}
+
+void furi_thread_free(FuriThread* thread) {
+    pthread_mutex_destroy(&thread->host.lock);
+    pthread_cond_destroy(&thread->host.cond);
+    free(thread);
+}
+
+static void* host_thread_body(void* arg) {
+    FuriThread* thread = arg;
+    current_thread = &thread->host;
+    pthread_mutex_lock(&thread->host.lock);
+    thread->state = FuriThreadStateRunning;
+    pthread_mutex_unlock(&thread->host.lock);
+    int32_t ret = thread->callback(thread->context);
+    pthread_mutex_lock(&thread->host.lock);
+    thread->ret = ret;
+    thread->state = FuriThreadStateStopped;
+    pthread_mutex_unlock(&thread->host.lock);
+    return NULL;
+}
+
+void furi_thread_start(FuriThread* thread) {
+    thread->state = FuriThreadStateStarting;
+    furi_check(pthread_create(&thread->pthread, NULL, host_thread_body, thread) == 0);
+}
+
+bool furi_thread_join(FuriThread* thread) {
+    return pthread_join(thread->pthread, NULL) == 0;
+}
+
+FuriThreadState furi_thread_get_state(FuriThread* thread) {
+    pthread_mutex_lock(&thread->host.lock);
+    FuriThreadState state = thread->state;
+    pthread_mutex_unlock(&thread->host.lock);
+    return state;
+}
+
+FuriThreadId furi_thread_get_id(FuriThread* thread) {
+    return &thread->host;
+}
+
+int32_t furi_thread_get_return_code(FuriThread* thread) {
+    return thread->ret;
+}
+
+uint32_t furi_thread_get_stack_space(FuriThreadId thread_id) {
+    /* The host record sits first in FuriThread */
+    return ((FuriThread*)thread_id)->stack_size;
+}
+
+uint32_t furi_thread_flags_set(FuriThreadId thread_id, uint32_t flags) {
+    pthread_mutex_lock(&thread_id->lock);
+    thread_id->flags |= flags;
+    uint32_t now = thread_id->flags;
+    pthread_cond_broadcast(&thread_id->cond);
+    pthread_mutex_unlock(&thread_id->lock);
+    return now;
+}
+
+uint32_t furi_thread_flags_clear(uint32_t flags) {
+    struct FuriThreadHost* self = furi_thread_get_current_id();
+    pthread_mutex_lock(&self->lock);
+    uint32_t before = self->flags;
+    self->flags &= ~flags;
+    pthread_mutex_unlock(&self->lock);
+    return before;
+}
+
+uint32_t furi_thread_flags_get(void) {
+    struct FuriThreadHost* self = furi_thread_get_current_id();
+    pthread_mutex_lock(&self->lock);
+    uint32_t flags = self->flags;
+    pthread_mutex_unlock(&self->lock);
+    return flags;
+}
+
+uint32_t furi_thread_flags_wait(uint32_t flags, uint32_t options, uint32_t timeout) {
+    struct FuriThreadHost* self = furi_thread_get_current_id();
+    struct timespec until = host_deadline(timeout == FuriWaitForever ? 0 : timeout);
+    pthread_mutex_lock(&self->lock);
+    uint32_t result;
+    for(;;) {
+        uint32_t got = self->flags & flags;
+        bool done = (options & FuriFlagWaitAll) ? got == flags : got != 0;
+        if(done) {
+            result = self->flags;
+            if(!(options & FuriFlagNoClear)) self->flags &= ~flags;
+            break;
+        }
+        if(timeout == 0) {
+            result = FuriFlagErrorResource;
+            break;
+        }
+        int err = timeout == FuriWaitForever ? pthread_cond_wait(&self->cond, &self->lock) :
+                                               pthread_cond_timedwait(&self->cond, &self->lock, &until);
+        if(err == ETIMEDOUT) {
+            result = FuriFlagErrorTimeout;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&self->lock);
+    return result;
+}
+
+FuriMutex* furi_mutex_alloc(FuriMutexType type) {
+    FuriMutex* mutex = malloc(sizeof(FuriMutex));
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    if(type == FuriMutexTypeRecursive) pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&mutex->lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+    return mutex;
+}
+
+void furi_mutex_free(FuriMutex* mutex) {
+    pthread_mutex_destroy(&mutex->lock);
+    free(mutex);
+}
+
+FuriStatus furi_mutex_acquire(FuriMutex* mutex, uint32_t timeout) {
+    if(timeout == FuriWaitForever) return pthread_mutex_lock(&mutex->lock) ? FuriStatusError : FuriStatusOk;
+    if(timeout == 0) return pthread_mutex_trylock(&mutex->lock) ? FuriStatusErrorResource : FuriStatusOk;
+    struct timespec until = host_deadline(timeout);
+    return pthread_mutex_timedlock(&mutex->lock, &until) ? FuriStatusErrorTimeout : FuriStatusOk;
+}
+
+FuriStatus furi_mutex_release(FuriMutex* mutex) {
+    return pthread_mutex_unlock(&mutex->lock) ? FuriStatusError : FuriStatusOk;
+}
+
+uint32_t furi_hal_host_rtc;
+
+FuriHalHostDwt* furi_hal_host_dwt(void) {
+    static __thread FuriHalHostDwt dwt;
+    dwt.CYCCNT = (uint32_t)host_now_ns();
+    return &dwt;
+}
+
+uint32_t furi_hal_cortex_instructions_per_microsecond(void) {
+    return 1000;
+}
+
+uint32_t furi_hal_random_get(void) {
+    static __thread uint32_t state;
+    if(!state) state = (uint32_t)host_now_ns() | 1;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+uint32_t furi_hal_rtc_get_timestamp(void) {
+    return furi_hal_host_rtc ? furi_hal_host_rtc : (uint32_t)time(NULL);
+}
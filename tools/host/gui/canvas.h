@@ -0,0 +1,79 @@
+#pragma once
+
+/*
+ * Host stand-in for the canvas. Every draw call is recorded, and the
+ * primitives are rasterized into a 128x64 framebuffer the way u8g2 does
+ * on the device, so tools can count draw calls and compare pixels.
+ * Strings are recorded but not rasterized.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define CANVAS_HOST_W 128
+#define CANVAS_HOST_H 64
+#define CANVAS_HOST_CALLS 512
+
+typedef enum {
+    ColorWhite = 0x00,
+    ColorBlack = 0x01,
+    ColorXOR = 0x02,
+} Color;
+
+typedef enum {
+    FontPrimary,
+    FontSecondary,
+    FontKeyboard,
+    FontBigNumbers,
+} Font;
+
+typedef enum {
+    AlignLeft,
+    AlignRight,
+    AlignTop,
+    AlignBottom,
+    AlignCenter,
+} Align;
+
+typedef enum {
+    CanvasCallClear,
+    CanvasCallDot,
+    CanvasCallLine,
+    CanvasCallFrame,
+    CanvasCallBox,
+    CanvasCallCircle,
+    CanvasCallXbm,
+    CanvasCallStr,
+} CanvasCallKind;
+
+typedef struct {
+    uint8_t kind; /* CanvasCallKind */
+    int32_t x, y;
+    int32_t a, b; /* Second point, size or radius, by kind */
+} CanvasCall;
+
+typedef struct {
+    uint8_t fb[CANVAS_HOST_H][CANVAS_HOST_W]; /* One byte per pixel, 0 or 1 */
+    CanvasCall calls[CANVAS_HOST_CALLS];
+    size_t count; /* Calls made, including any past CANVAS_HOST_CALLS */
+    Color color;
+    Font font;
+} Canvas;
+
+/* Clears the framebuffer and the call log */
+void canvas_host_reset(Canvas* canvas);
+/* Draw calls made since the reset, not counting canvas_clear() */
+size_t canvas_host_draw_calls(const Canvas* canvas);
+
+void canvas_clear(Canvas* canvas);
+void canvas_set_color(Canvas* canvas, Color color);
+void canvas_set_font(Canvas* canvas, Font font);
+void canvas_draw_dot(Canvas* canvas, int32_t x, int32_t y);
+void canvas_draw_line(Canvas* canvas, int32_t x1, int32_t y1, int32_t x2, int32_t y2);
+void canvas_draw_frame(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height);
+void canvas_draw_box(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height);
+void canvas_draw_circle(Canvas* canvas, int32_t x, int32_t y, size_t radius);
+void canvas_draw_xbm(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height, const uint8_t* bitmap);
+void canvas_draw_str(Canvas* canvas, int32_t x, int32_t y, const char* str);
+void canvas_draw_str_aligned(Canvas* canvas, int32_t x, int32_t y, Align horizontal, Align vertical, const char* str);
@@ -0,0 +1,52 @@
+#pragma once
+
+/*
+ * Minimal checks for the host tests: a failed CHECK prints where and
+ * carries on, and host_test_done() turns the tally into the exit status.
+ * host_app_new() is the one app fixture the tests and tools share.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "cyber_fishing_game.h"
+
+static int host_test_failures __attribute__((unused));
+
+#define CHECK(cond)                                                          \
+    do {                                                                     \
+        if(!(cond)) {                                                        \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            host_test_failures++;                                            \
+        }                                                                    \
+    } while(0)
+
+#define CHECK_EQ(a, b)                                                       \
+    do {                                                                     \
+        unsigned long long check_a = (unsigned long long)(a);               \
+        unsigned long long check_b = (unsigned long long)(b);               \
+        if(check_a != check_b) {                                             \
+            fprintf(stderr, "%s:%d: %s == %s failed: %llu != %llu\n", __FILE__, __LINE__, #a, #b, check_a, check_b); \
+            host_test_failures++;                                            \
+        }                                                                    \
+    } while(0)
+
+static inline int host_test_done(const char* name) {
+    if(host_test_failures) {
+        fprintf(stderr, "%s: %d check(s) failed\n", name, host_test_failures);
+        return 1;
+    }
+    printf("%s: ok\n", name);
+    return 0;
+}
+
+/* A new player on the splash at clock time 0: defaults, core 1, seeded */
+static inline CyberFishApp* host_app_new(uint32_t seed) {
+    CyberFishApp* app = malloc(sizeof(CyberFishApp));
+    game_init(app);
+    reset_game(app);
+    app->progress.core_ver = 1;
+    game_seed(app, seed);
+    game_start(app, 0);
+    return app;
+}
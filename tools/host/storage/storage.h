@@ -0,0 +1,74 @@
+#pragma once
+
+/*
+ * Host stand-in for the storage service. /ext/ paths are mapped into a
+ * directory on the host, a fresh temp dir unless storage_host_set_root()
+ * picked one, and files are plain stdio streams. Counters let the tools
+ * measure what a policy writes.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define RECORD_STORAGE "storage"
+#define EXT_PATH(path) "/ext/" path
+
+typedef struct Storage Storage;
+typedef struct File File;
+
+typedef enum {
+    FSAM_READ = (1 << 0),
+    FSAM_WRITE = (1 << 1),
+    FSAM_READ_WRITE = FSAM_READ | FSAM_WRITE,
+} FS_AccessMode;
+
+typedef enum {
+    FSOM_OPEN_EXISTING = 1,
+    FSOM_OPEN_ALWAYS = 2,
+    FSOM_OPEN_APPEND = 4,
+    FSOM_CREATE_NEW = 8,
+    FSOM_CREATE_ALWAYS = 16,
+} FS_OpenMode;
+
+typedef enum {
+    FSE_OK,
+    FSE_NOT_READY,
+    FSE_EXIST,
+    FSE_NOT_EXIST,
+    FSE_INVALID_PARAMETER,
+    FSE_DENIED,
+    FSE_INVALID_NAME,
+    FSE_INTERNAL,
+    FSE_NOT_IMPLEMENTED,
+    FSE_ALREADY_OPEN,
+} FS_Error;
+
+File* storage_file_alloc(Storage* storage);
+void storage_file_free(File* file);
+bool storage_file_open(File* file, const char* path, FS_AccessMode access_mode, FS_OpenMode open_mode);
+bool storage_file_close(File* file);
+size_t storage_file_read(File* file, void* buff, size_t bytes_to_read);
+size_t storage_file_write(File* file, const void* buff, size_t bytes_to_write);
+bool storage_file_seek(File* file, uint32_t offset, bool from_start);
+uint64_t storage_file_size(File* file);
+
+FS_Error storage_common_mkdir(Storage* storage, const char* path);
+FS_Error storage_common_remove(Storage* storage, const char* path);
+FS_Error storage_common_rename(Storage* storage, const char* old_path, const char* new_path);
+
+typedef struct {
+    uint32_t opens; /* Opened for writing */
+    uint32_t writes;
+    uint64_t bytes;
+    uint32_t renames;
+} StorageHostStats;
+
+extern StorageHostStats storage_host_stats;
+/* Set to behave like older firmware, which refuses to rename over a file */
+extern bool storage_host_rename_no_replace;
+
+void storage_host_set_root(const char* dir);
+const char* storage_host_root(void);
+/* Host path of an /ext/ path; the result is valid until the next call */
+const char* storage_host_path(const char* path);
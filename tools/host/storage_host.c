@@ -0,0 +1,148 @@
+#define _XOPEN_SOURCE 700
+
+#include <storage/storage.h>
+
+#include <errno.h>
+#include <ftw.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct File {
+    FILE* fp;
+};
+
+StorageHostStats storage_host_stats;
+bool storage_host_rename_no_replace;
+
+static char root[256];
+static bool root_is_temp;
+
+static int remove_entry(const char* path, const struct stat* st, int flag, struct FTW* ftw) {
+    (void)st;
+    (void)flag;
+    (void)ftw;
+    return remove(path);
+}
+
+static void remove_temp_root(void) {
+    if(root_is_temp) nftw(root, remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+void storage_host_set_root(const char* dir) {
+    snprintf(root, sizeof(root), "%s", dir);
+    root_is_temp = false;
+}
+
+const char* storage_host_root(void) {
+    if(!root[0]) {
+        snprintf(root, sizeof(root), "%s/cyber_fishing_XXXXXX", getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp");
+        if(!mkdtemp(root)) {
+            perror("mkdtemp");
+            exit(1);
+        }
+        root_is_temp = true;
+        atexit(remove_temp_root);
+    }
+    return root;
+}
+
+const char* storage_host_path(const char* path) {
+    static __thread char host[512];
+    const char* base = storage_host_root();
+    if(strncmp(path, "/ext", 4) == 0) path += 4;
+    snprintf(host, sizeof(host), "%s%s", base, path);
+    return host;
+}
+
+File* storage_file_alloc(Storage* storage) {
+    (void)storage;
+    return calloc(1, sizeof(File));
+}
+
+void storage_file_free(File* file) {
+    if(file->fp) fclose(file->fp);
+    free(file);
+}
+
+bool storage_file_open(File* file, const char* path, FS_AccessMode access_mode, FS_OpenMode open_mode) {
+    const char* host = storage_host_path(path);
+    const char* mode;
+    bool write = access_mode & FSAM_WRITE;
+    if(open_mode == FSOM_CREATE_NEW && access(host, F_OK) == 0) return false;
+    if(open_mode == FSOM_OPEN_APPEND) {
+        mode = access_mode & FSAM_READ ? "a+b" : "ab";
+    } else if(open_mode == FSOM_CREATE_ALWAYS || open_mode == FSOM_CREATE_NEW) {
+        mode = access_mode & FSAM_READ ? "w+b" : "wb";
+    } else if(open_mode == FSOM_OPEN_ALWAYS && access(host, F_OK) != 0) {
+        mode = "w+b";
+    } else {
+        mode = write ? "r+b" : "rb";
+    }
+    file->fp = fopen(host, mode);
+    if(file->fp && write) __atomic_add_fetch(&storage_host_stats.opens, 1, __ATOMIC_RELAXED);
+    return file->fp != NULL;
+}
+
+bool storage_file_close(File* file) {
+    if(!file->fp) return false;
+    bool ok = fclose(file->fp) == 0;
+    file->fp = NULL;
+    return ok;
+}
+
+size_t storage_file_read(File* file, void* buff, size_t bytes_to_read) {
+    return file->fp ? fread(buff, 1, bytes_to_read, file->fp) : 0;
+}
+
+size_t storage_file_write(File* file, const void* buff, size_t bytes_to_write) {
+    if(!file->fp) return 0;
+    size_t written = fwrite(buff, 1, bytes_to_write, file->fp);
+    __atomic_add_fetch(&storage_host_stats.writes, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&storage_host_stats.bytes, written, __ATOMIC_RELAXED);
+    return written;
+}
+
+bool storage_file_seek(File* file, uint32_t offset, bool from_start) {
+    return file->fp && fseek(file->fp, (long)offset, from_start ? SEEK_SET : SEEK_CUR) == 0;
+}
+
+uint64_t storage_file_size(File* file) {
+    struct stat st;
+    if(!file->fp || fflush(file->fp) || fstat(fileno(file->fp), &st)) return 0;
+    return (uint64_t)st.st_size;
+}
+
+static FS_Error storage_host_error(void) {
+    switch(errno) {
+    case EEXIST:
+    case ENOTEMPTY: return FSE_EXIST;
+    case ENOENT: return FSE_NOT_EXIST;
+    case EACCES:
+    case EPERM: return FSE_DENIED;
+    default: return FSE_INTERNAL;
+    }
+}
+
+FS_Error storage_common_mkdir(Storage* storage, const char* path) {
+    (void)storage;
+    return mkdir(storage_host_path(path), 0777) ? storage_host_error() : FSE_OK;
+}
+
+FS_Error storage_common_remove(Storage* storage, const char* path) {
+    (void)storage;
+    return remove(storage_host_path(path)) ? storage_host_error() : FSE_OK;
+}
+
+FS_Error storage_common_rename(Storage* storage, const char* old_path, const char* new_path) {
+    (void)storage;
+    char from[512];
+    snprintf(from, sizeof(from), "%s", storage_host_path(old_path));
+    const char* to = storage_host_path(new_path);
+    if(storage_host_rename_no_replace && access(to, F_OK) == 0) return FSE_EXIST;
+    if(rename(from, to)) return storage_host_error();
+    __atomic_add_fetch(&storage_host_stats.renames, 1, __ATOMIC_RELAXED);
+    return FSE_OK;
+}
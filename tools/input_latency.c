@@ -0,0 +1,117 @@
+/*
+ * Host latency test for the input ring under save load.
+ *
+ * A producer thread stands in for the input service: it pushes a short
+ * press into the SPSC ring every -p ms, through input_ring_push(). The
+ * consumer is the main loop's shape: input_ring_wait(), then drain, but
+ * every -e ms it stalls for -s ms as a save flush would. Reports the
+ * enqueue-to-dequeue latency (pop time minus the tick stamped at push)
+ * and the drops, and checks that nothing was lost or reordered.
+ *
+ * Built and run by `make test` in this directory.
+ *
+ *   build/input_latency [-d ms] [-p period] [-s stall] [-e every]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "cyber_fishing_input.h"
+#include "host_test.h"
+
+#define LATENCY_BUCKETS 256
+
+typedef struct {
+    InputRing* ring;
+    uint32_t duration_ms;
+    uint32_t period_ms;
+    volatile bool done;
+} Producer;
+
+static int32_t producer_worker(void* ctx) {
+    Producer* p = ctx;
+    InputEvent event = {.key = InputKeyOk, .type = InputTypeShort};
+    uint32_t start = furi_get_tick();
+    while(furi_get_tick() - start < p->duration_ms) {
+        /* Press and release never reach the ring; they cost the producer a test each */
+        event.type = InputTypePress;
+        input_ring_push(p->ring, &event);
+        event.type = InputTypeShort;
+        input_ring_push(p->ring, &event);
+        furi_delay_ms(p->period_ms);
+    }
+    __atomic_store_n(&p->done, true, __ATOMIC_RELEASE);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    uint32_t duration = 2000, period = 5, stall = 40, every = 250;
+    int opt;
+    while((opt = getopt(argc, argv, "d:p:s:e:")) != -1) {
+        switch(opt) {
+        case 'd': duration = strtoul(optarg, NULL, 0); break;
+        case 'p': period = strtoul(optarg, NULL, 0); break;
+        case 's': stall = strtoul(optarg, NULL, 0); break;
+        case 'e': every = strtoul(optarg, NULL, 0); break;
+        default:
+            fprintf(stderr, "usage: %s [-d ms] [-p period] [-s stall] [-e every]\n", argv[0]);
+            return 2;
+        }
+    }
+    if(period == 0) period = 1;
+    if(every == 0) every = 1;
+
+    static InputRing ring;
+    input_ring_init(&ring);
+    Producer producer = {.ring = &ring, .duration_ms = duration, .period_ms = period};
+    FuriThread* thread = furi_thread_alloc_ex("InputProducer", 1024, producer_worker, &producer);
+    furi_thread_start(thread);
+
+    static uint32_t hist[LATENCY_BUCKETS];
+    uint32_t popped = 0, worst = 0, stalls = 0, last_time = 0;
+    uint64_t sum = 0;
+    uint32_t last_stall = furi_get_tick();
+    for(;;) {
+        bool done = __atomic_load_n(&producer.done, __ATOMIC_ACQUIRE);
+        input_ring_wait(&ring, 10);
+        StampedInput in;
+        while(input_ring_pop(&ring, &in)) {
+            uint32_t lag = furi_get_tick() - in.time;
+            CHECK(in.time - last_time < 0x80000000u);
+            CHECK_EQ(in.type, InputTypeShort);
+            last_time = in.time;
+            hist[lag < LATENCY_BUCKETS ? lag : LATENCY_BUCKETS - 1]++;
+            if(lag > worst) worst = lag;
+            sum += lag;
+            popped++;
+        }
+        if(done && input_ring_count(&ring) == 0) break;
+        if(furi_get_tick() - last_stall >= every) {
+            /* A save flush: the loop does not look at the ring for this long */
+            furi_delay_ms(stall);
+            last_stall = furi_get_tick();
+            stalls++;
+        }
+    }
+    furi_thread_join(thread);
+    furi_thread_free(thread);
+
+    uint32_t p99 = 0, seen = 0;
+    for(uint32_t b=0; b<LATENCY_BUCKETS; b++) {
+        seen += hist[b];
+        if(seen * 100ull >= popped * 99ull) {
+            p99 = b;
+            break;
+        }
+    }
+    printf(
+        "pushed=%lu popped=%lu dropped=%lu stalls=%lu stall_ms=%lu mean_ms=%.2f p99_ms=%lu worst_ms=%lu\n",
+        (unsigned long)ring.pushed, (unsigned long)popped, (unsigned long)ring.dropped, (unsigned long)stalls,
+        (unsigned long)stall, popped ? (double)sum / popped : 0.0, (unsigned long)p99, (unsigned long)worst);
+    /* Every press the ring accepted came out, once */
+    CHECK_EQ(ring.pushed, popped);
+    /* A stall only drops presses when it spans more of them than the ring holds */
+    if(stall / period < INPUT_RING_SIZE) CHECK_EQ(ring.dropped, 0);
+    return host_test_done("input_latency");
+}
@@ -0,0 +1,82 @@
+/*
+ * Host check for the pre-rendered world layer.
+ *
+ * For every scene, draws the static scenery the way draw_world_bg() and
+ * render_callback() drew it before the layer existed, one canvas call
+ * per primitive, and separately blits the layer from world_layer_prepare().
+ * The canvas stand-in rasterizes both with u8g2's line and circle
+ * algorithms, and the two framebuffers must match pixel for pixel.
+ * Prints the draw calls each way per scene.
+ *
+ * Built and run by `make test` in this directory.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <gui/canvas.h>
+
+#include "cyber_fishing_layer.h"
+
+#define LAYER_SCENES 5
+
+/* The static part of the old draw list, as it was before the layer cache */
+static void legacy_draw_scene(Canvas* canvas, int scene) {
+    if(scene == 0) {
+        canvas_draw_line(canvas, 0, 45, 55, 45);
+        canvas_draw_line(canvas, 10, 45, 10, 60);
+        canvas_draw_line(canvas, 40, 45, 40, 60);
+    } else if(scene == 1) {
+        for(int i=0; i<60; i+=15) {
+            canvas_draw_line(canvas, i, 45, i+5, 20);
+            canvas_draw_line(canvas, i+5, 20, i+10, 45);
+        }
+        canvas_draw_line(canvas, 0, 45, 55, 45);
+    } else if(scene == 2) {
+        canvas_draw_frame(canvas, 5, 20, 10, 25);
+        canvas_draw_frame(canvas, 25, 10, 15, 35);
+        canvas_draw_line(canvas, 0, 45, 55, 45);
+    } else if(scene == 3) {
+        for(int i=0; i<15; i++) {
+            canvas_draw_dot(canvas, (i*17)%128, (i*9)%45);
+        }
+        canvas_draw_line(canvas, 0, 45, 55, 45);
+    } else if(scene == 4) {
+        canvas_draw_line(canvas, 0, 45, 55, 45);
+    }
+    /* The fisher, drawn by render_callback() after the background */
+    canvas_draw_circle(canvas, 45, 35, 3);
+    canvas_draw_line(canvas, 45, 38, 45, 43);
+}
+
+int main(void) {
+    static Canvas legacy, cached;
+    static WorldLayer layer = {.world = -1};
+    int failed = 0;
+    printf("scene,legacy_calls,layer_calls,pixels,mismatches,layer_bytes\n");
+    for(int scene=0; scene<LAYER_SCENES; scene++) {
+        canvas_host_reset(&legacy);
+        canvas_host_reset(&cached);
+        legacy_draw_scene(&legacy, scene);
+        world_layer_prepare(&layer, scene);
+        canvas_draw_xbm(&cached, layer.x, layer.y, layer.w, layer.h, layer.bits);
+
+        uint32_t pixels = 0, mismatches = 0;
+        for(int y=0; y<CANVAS_HOST_H; y++) {
+            for(int x=0; x<CANVAS_HOST_W; x++) {
+                pixels += legacy.fb[y][x];
+                mismatches += legacy.fb[y][x] != cached.fb[y][x];
+            }
+        }
+        printf(
+            "%d,%zu,%zu,%lu,%lu,%u\n", scene, canvas_host_draw_calls(&legacy), canvas_host_draw_calls(&cached),
+            (unsigned long)pixels, (unsigned long)mismatches, (unsigned)(layer.w / 8 * layer.h));
+        if(mismatches || pixels == 0) failed++;
+    }
+    if(failed) {
+        fprintf(stderr, "layer_check: %d scene(s) differ from the direct draw\n", failed);
+        return 1;
+    }
+    printf("layer_check: ok\n");
+    return 0;
+}
@@ -0,0 +1,85 @@
+/*
+ * Host check for the rarity table against the roll it replaced.
+ *
+ * The bite tier used to be a nested ternary over
+ * r = rand() % 100 + antenna_lvl * 4 + world * 20. For every antenna
+ * level and world depth this check
+ *  - counts the ternary's tier for each of the 100 possible draws and
+ *    requires the table's weights to match exactly, and
+ *  - samples both the old roll (modulo draw) and rarity_sample()
+ *    (multiply-shift draw) and requires every tier frequency to agree
+ *    within five standard deviations.
+ *
+ * Built and run by `make test` in this directory; -n sets the samples per
+ * (antenna, depth) pair.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "cyber_fishing_game.h"
+
+#define CHECK_DEPTHS CONTENT_MAX_WORLDS
+
+/* The original bite roll, verbatim apart from the draw */
+static int legacy_tier(uint32_t u, uint32_t antenna_lvl, int world) {
+    int r = u + (antenna_lvl * 4) + (world * 20);
+    return (r > 180) ? 6 : (r > 150) ? 5 : (r > 120) ? 4 : (r > 90) ? 3 : (r > 70) ? 2 : (r > 40) ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    uint32_t samples = 4000;
+    int opt;
+    while((opt = getopt(argc, argv, "n:")) != -1) {
+        if(opt != 'n') {
+            fprintf(stderr, "usage: %s [-n samples]\n", argv[0]);
+            return 2;
+        }
+        samples = strtoul(optarg, NULL, 0);
+    }
+    if(samples == 0) samples = 1;
+
+    uint32_t weight_errors = 0, freq_errors = 0;
+    double worst_sigma = 0;
+    uint32_t rng_old = rng_seed_state(1), rng_new = rng_seed_state(2);
+    for(uint32_t antenna=0; antenna<=LEVEL_MAX; antenna++) {
+        for(int depth=0; depth<CHECK_DEPTHS; depth++) {
+            RarityTable table;
+            rarity_table_build(&table, antenna, depth);
+            uint32_t exact[RARITY_TIERS] = {0};
+            for(uint32_t u=0; u<RARITY_ROLLS; u++) exact[legacy_tier(u, antenna, depth)]++;
+
+            uint32_t old_hits[RARITY_TIERS] = {0}, new_hits[RARITY_TIERS] = {0};
+            for(uint32_t i=0; i<samples; i++) {
+                old_hits[legacy_tier(rng_next(&rng_old) % 100, antenna, depth)]++;
+                new_hits[rarity_sample(&table, &rng_new)]++;
+            }
+            for(int t=0; t<RARITY_TIERS; t++) {
+                if(table.weight[t] != exact[t]) {
+                    if(weight_errors++ < 10) {
+                        fprintf(stderr, "antenna %lu depth %d tier %d: weight %u, ternary %lu\n",
+                                (unsigned long)antenna, depth, t, table.weight[t], (unsigned long)exact[t]);
+                    }
+                }
+                double p = exact[t] / (double)RARITY_ROLLS;
+                double sd = sqrt(2 * p * (1 - p) / samples);
+                double diff = fabs((double)old_hits[t] - new_hits[t]) / samples;
+                if(sd > 0 && diff / sd > worst_sigma) worst_sigma = diff / sd;
+                /* A tier the ternary never reaches must never be sampled */
+                if(diff > 5 * sd + 0.5 / samples) freq_errors++;
+            }
+        }
+    }
+    printf(
+        "pairs=%lu samples=%lu weight_errors=%lu freq_errors=%lu worst=%.2f sd\n",
+        (unsigned long)(LEVEL_MAX + 1) * CHECK_DEPTHS, (unsigned long)samples, (unsigned long)weight_errors,
+        (unsigned long)freq_errors, worst_sigma);
+    if(weight_errors || freq_errors) {
+        fprintf(stderr, "rarity_check: table and ternary disagree\n");
+        return 1;
+    }
+    printf("rarity_check: ok\n");
+    return 0;
+}
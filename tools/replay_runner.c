@@ -0,0 +1,116 @@
+/*
+ * Host runner for input recordings.
+ *
+ * Replays a cyber_fishing.rec pulled off the SD card at full speed through
+ * the same replay_run() the admin terminal uses, and prints the recorded
+ * and replayed digests (clock, PRNG state, screen and the CRC of the final
+ * save_encode() image). Exits non-zero if they differ.
+ *
+ * Without a file it records a scripted session into the storage stand-in
+ * first, so `make test` covers record and replay end to end.
+ *
+ *   build/replay_runner [file.rec]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <furi.h>
+#include <storage/storage.h>
+
+#include "cyber_fishing_replay.h"
+#include "host_test.h"
+
+#define RUNNER_PATH EXT_PATH("apps_data/cyber_fishing.rec")
+#define RUNNER_CASTS 200
+
+static bool runner_copy_in(const char* src) {
+    FILE* in = fopen(src, "rb");
+    if(!in) {
+        perror(src);
+        return false;
+    }
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    storage_common_mkdir(storage, EXT_PATH("apps_data"));
+    File* out = storage_file_alloc(storage);
+    bool ok = storage_file_open(out, RUNNER_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS);
+    uint8_t buf[4096];
+    size_t len;
+    while(ok && (len = fread(buf, 1, sizeof(buf), in)) > 0) ok = storage_file_write(out, buf, len) == len;
+    storage_file_close(out);
+    storage_file_free(out);
+    furi_record_close(RECORD_STORAGE);
+    fclose(in);
+    return ok;
+}
+
+static uint32_t runner_input(CyberFishApp* app, ReplayRecorder* rec, GameKey key, uint32_t time) {
+    GameInput input = {.key = key, .type = GameInputShort, .time = time};
+    replay_record_input(rec, &input);
+    return game_step(app, &input, time);
+}
+
+/* Casts, reels in on a varying delay (some bites get away) and sells now and then */
+static bool runner_record(void) {
+    CyberFishApp* app = host_app_new(0xC0FFEEu);
+    game_start(app, 1000);
+    game_step(app, NULL, 1000 + GAME_SPLASH_MS);
+    ReplayRecorder rec;
+    replay_recorder_init(&rec);
+    bool ok = replay_record_start(&rec, app);
+    uint32_t now = app->ui.now_ms;
+    for(uint32_t i=0; ok && i<RUNNER_CASTS; i++) {
+        while(app->ui.current_state != StateWaiting) runner_input(app, &rec, GameKeyOk, now += GAME_LOST_HOLD_MS);
+        runner_input(app, &rec, GameKeyOk, now += 300);
+        now = app->ui.deadline;
+        /* The step that notices the bite runs a little late, like the main loop */
+        game_step(app, NULL, now + 7);
+        runner_input(app, &rec, GameKeyOk, now += 200 + (i * 397) % 4000);
+        game_step(app, NULL, now += 50);
+        runner_input(app, &rec, GameKeyOk, now += GAME_LOST_HOLD_MS);
+        if(i % 25 == 24) {
+            while(app->ui.current_state != StateWaiting) runner_input(app, &rec, GameKeyOk, now += GAME_LOST_HOLD_MS);
+            runner_input(app, &rec, GameKeyDown, now += 300);
+            while(app->progress.inv_used) runner_input(app, &rec, GameKeyOk, now += 200);
+            runner_input(app, &rec, GameKeyBack, now += 300);
+        }
+    }
+    /* Ends mid-cast, so the replay has timers left to run after the last input */
+    runner_input(app, &rec, GameKeyOk, now += 300);
+    game_step(app, NULL, now += 1234);
+    replay_record_stop(&rec, app);
+    printf("recorded %lu inputs over %lu ms\n", (unsigned long)rec.events, (unsigned long)(now - 1000));
+    free(app);
+    return ok;
+}
+
+static void runner_print(const char* label, const ReplayDigest* d) {
+    printf(
+        "%s: time=%lu rng=%08lx state=%lu save_crc=%08lx\n", label, (unsigned long)d->time,
+        (unsigned long)d->rng_state, (unsigned long)d->state, (unsigned long)d->save_crc);
+}
+
+int main(int argc, char** argv) {
+    if(argc > 2) {
+        fprintf(stderr, "usage: %s [file.rec]\n", argv[0]);
+        return 2;
+    }
+    content_load(NULL);
+    game_events_init();
+    if(argc == 2 ? !runner_copy_in(argv[1]) : !runner_record()) return 1;
+
+    ReplayResult result;
+    replay_run(&result);
+    if(!result.loaded) {
+        fprintf(stderr, "not a complete version %d recording for this build\n", REPLAY_VERSION);
+        return 1;
+    }
+    printf(
+        "replayed %lu inputs, %lu saves, %lu ms of game time in %lu ms\n", (unsigned long)result.events,
+        (unsigned long)result.saves, (unsigned long)result.span_ms, (unsigned long)result.elapsed_ms);
+    runner_print("recorded", &result.expected);
+    runner_print("replayed", &result.actual);
+    printf("replay_runner: %s\n", result.match ? "match" : "MISMATCH");
+    return result.match ? 0 : 1;
+}
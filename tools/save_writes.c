@@ -0,0 +1,203 @@
+/*
+ * Host driver for the save engine's write traffic.
+ *
+ * Plays the same scripted session twice through game_step(), once with
+ * the old policy (write the save on every step that asks for one) and
+ * once with the debounced engine (save_mark_dirty() on those steps,
+ * save_poll() at the deadline it returns, save_flush() on exit), and
+ * prints the file writes and bytes each one made. Both policies write
+ * the same image format, so the difference is only how often.
+ *
+ * The scripted player casts, reels in after a human-ish reaction time,
+ * sells its hold one packet at a time once it holds -h packets, and buys
+ * the cheapest upgrade it can afford.
+ *
+ * Build with `make -C tools`, then: build/save_writes [-m minutes] [-s seed] [-h hold]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <furi.h>
+
+#include "cyber_fishing_game.h"
+#include "cyber_fishing_save.h"
+#include "host_test.h"
+
+#define DRIVER_PRESS_MS 250
+#define DRIVER_REACT_MIN_MS 250
+#define DRIVER_REACT_SPAN_MS 900
+#define DRIVER_NEVER UINT32_MAX
+
+typedef enum {
+    PolicyEveryEffect,
+    PolicyDebounced,
+} SavePolicy;
+
+static const char* const policy_names[] = {"every_effect", "debounced"};
+
+typedef struct {
+    uint32_t minutes;
+    uint32_t seed;
+    uint32_t hold_limit;
+} DriverConfig;
+
+typedef struct {
+    uint32_t requests; /* Steps that returned GameEffectSave */
+    uint32_t writes;
+    uint32_t bytes;
+    uint32_t catches;
+} DriverResult;
+
+typedef struct {
+    bool valid;
+    GameInput input;
+} DriverPlan;
+
+static uint32_t driver_rand(uint32_t* state, uint32_t n) {
+    return rng_range(state, n);
+}
+
+static int driver_upgrade(const CyberFishApp* app) {
+    static const uint32_t cost[3] = {SHOP_BUFFER_COST, SHOP_ANTENNA_COST, SHOP_LURE_COST};
+    const uint8_t levels[3] = {app->progress.buffer_lvl, app->progress.antenna_lvl, app->progress.lure_lvl};
+    int best = -1;
+    for(int i=0; i<3; i++) {
+        if(levels[i] == LEVEL_MAX || app->progress.credits < cost[i]) continue;
+        if(best < 0 || cost[i] < cost[best]) best = i;
+    }
+    return best;
+}
+
+static uint32_t driver_hold(const CyberFishApp* app) {
+    uint32_t held = 0;
+    for(int i=0; i<app->progress.inv_used; i++) held += app->progress.inv[i].count;
+    return held;
+}
+
+/* What the player does next from the current screen, if anything before a timer */
+static DriverPlan driver_plan(const CyberFishApp* app, const DriverConfig* cfg, uint32_t now, uint32_t* rng, int* shop_item) {
+    DriverPlan plan = {.valid = true, .input = {.type = GameInputShort, .time = now + DRIVER_PRESS_MS}};
+    switch(app->ui.current_state) {
+    case StateWaiting:
+        if(driver_hold(app) >= cfg->hold_limit) {
+            plan.input.key = GameKeyDown;
+        } else if((*shop_item = driver_upgrade(app)) >= 0) {
+            plan.input.key = GameKeyUp;
+        } else {
+            plan.input.key = GameKeyOk;
+        }
+        break;
+    case StateBite:
+        plan.input.key = GameKeyOk;
+        plan.input.time = app->ui.bite_at + DRIVER_REACT_MIN_MS + driver_rand(rng, DRIVER_REACT_SPAN_MS);
+        break;
+    case StateCaught:
+    case StateLost:
+        plan.input.key = GameKeyOk;
+        plan.input.time = now + GAME_LOST_HOLD_MS + DRIVER_PRESS_MS;
+        break;
+    case StateSell:
+        plan.input.key = app->progress.inv_used ? GameKeyOk : GameKeyBack;
+        break;
+    case StateShop:
+        if(*shop_item >= 0 && app->ui.shop_cursor != *shop_item) {
+            plan.input.key = GameKeyDown;
+        } else if(*shop_item >= 0) {
+            plan.input.key = GameKeyOk;
+            *shop_item = -1;
+        } else {
+            plan.input.key = GameKeyBack;
+        }
+        break;
+    default:
+        /* Splash and fishing wait for their timers */
+        plan.valid = false;
+        break;
+    }
+    return plan;
+}
+
+static void driver_run(const DriverConfig* cfg, SavePolicy policy, DriverResult* result) {
+    CyberFishApp* app = host_app_new(cfg->seed);
+    SaveEngine engine;
+    save_engine_init(&engine);
+    memset(result, 0, sizeof(DriverResult));
+
+    uint32_t rng = rng_seed_state(cfg->seed ^ 0x5A5A5A5Au);
+    uint32_t end = cfg->minutes * 60000;
+    uint32_t now = 0, save_at = DRIVER_NEVER;
+    int shop_item = -1;
+    DriverPlan plan = {0};
+    while(now < end) {
+        if(!plan.valid) plan = driver_plan(app, cfg, now, &rng, &shop_item);
+        uint32_t timeout = game_timeout(app, now);
+        uint32_t next = timeout == GAME_NO_DEADLINE ? DRIVER_NEVER : now + timeout;
+        if(plan.valid && plan.input.time < next) next = plan.input.time;
+        if(save_at < next) next = save_at;
+        if(next == DRIVER_NEVER) break;
+
+        uint32_t fx;
+        if(plan.valid && plan.input.time == next) {
+            fx = game_step(app, &plan.input, next);
+            plan.valid = false;
+        } else {
+            uint8_t before = app->ui.current_state;
+            fx = game_step(app, NULL, next);
+            /* A timer moved the screen on, so the plan was made for the old one */
+            if(app->ui.current_state != before) plan.valid = false;
+        }
+        now = next;
+        if(fx & GameEffectCatch) result->catches++;
+        if(fx & GameEffectSave) {
+            result->requests++;
+            save_mark_dirty(&engine, now);
+            if(policy == PolicyEveryEffect) save_flush(&engine, app);
+        }
+        if(policy == PolicyDebounced) {
+            uint32_t wait = save_poll(&engine, app, now);
+            save_at = wait == FuriWaitForever ? DRIVER_NEVER : now + wait;
+        }
+    }
+    /* Leaving the app flushes whatever is pending */
+    save_flush(&engine, app);
+    result->writes = engine.writes;
+    result->bytes = engine.bytes_written;
+    free(app);
+}
+
+static void driver_usage(const char* argv0) {
+    fprintf(stderr, "usage: %s [-m minutes] [-s seed] [-h hold]\n", argv0);
+}
+
+int main(int argc, char** argv) {
+    DriverConfig cfg = {.minutes = 30, .seed = 1, .hold_limit = 20};
+    int opt;
+    while((opt = getopt(argc, argv, "m:s:h:")) != -1) {
+        switch(opt) {
+        case 'm': cfg.minutes = strtoul(optarg, NULL, 0); break;
+        case 's': cfg.seed = strtoul(optarg, NULL, 0); break;
+        case 'h': cfg.hold_limit = strtoul(optarg, NULL, 0); break;
+        default: driver_usage(argv[0]); return 2;
+        }
+    }
+    if(cfg.minutes == 0 || cfg.minutes > 60 * 24 * 7) {
+        driver_usage(argv[0]);
+        return 2;
+    }
+    if(cfg.hold_limit == 0) cfg.hold_limit = 1;
+
+    content_load(NULL);
+    game_events_init();
+    printf("policy,minutes,catches,save_requests,writes,bytes\n");
+    for(int p=PolicyEveryEffect; p<=PolicyDebounced; p++) {
+        DriverResult r;
+        driver_run(&cfg, (SavePolicy)p, &r);
+        printf(
+            "%s,%lu,%lu,%lu,%lu,%lu\n", policy_names[p], (unsigned long)cfg.minutes, (unsigned long)r.catches,
+            (unsigned long)r.requests, (unsigned long)r.writes, (unsigned long)r.bytes);
+    }
+    return 0;
+}
@@ -0,0 +1,148 @@
+/*
+ * Host test for the offline auto-trawler's closed form against brute force.
+ *
+ *  - trawler_mean_wait_ms() must equal the mean cast wait over every
+ *    integer draw, for each cast base the upgrades can produce.
+ *  - A bot then plays several days through game_step(): it casts, reels in
+ *    every bite and recasts TRAWLER_HANDLE_MS later, and keeps
+ *    TRAWLER_YIELD_PCT of the catches. Its cycle time, kept catches and
+ *    per-tier split must match trawler_expected_catches() and the rarity
+ *    weights within five standard deviations.
+ *  - trawler_run() over the same span must credit a total within the
+ *    noise bound it promises.
+ *
+ * Built and run by `make test` in this directory; -d sets the simulated days.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "cyber_fishing_trawler.h"
+#include "host_test.h"
+
+typedef struct {
+    uint8_t lure;
+    uint8_t antenna;
+    uint8_t world;
+} TrawlerCase;
+
+/* Seeds are full-width like furi_hal_random_get(); xorshift's first draws from a small seed run low */
+static CyberFishApp* trawler_app(const TrawlerCase* c, uint32_t seed) {
+    CyberFishApp* app = host_app_new(seed);
+    app->progress.lure_lvl = c->lure;
+    app->progress.antenna_lvl = c->antenna;
+    app->progress.world_unlocked = (1u << content_world_count()) - 1;
+    app->progress.current_world = c->world;
+    game_sync_rarity(app);
+    return app;
+}
+
+static void test_mean_wait(void) {
+    /* Every base down to where all draws clamp, and the far end of the lure levels */
+    int32_t low = GAME_TICK_MS - GAME_CAST_SPREAD_MS - 100;
+    for(int32_t base=low; base<=1000; base++) {
+        int64_t sum = 0;
+        for(int32_t u=0; u<GAME_CAST_SPREAD_MS; u++) sum += u + base > GAME_TICK_MS ? u + base : GAME_TICK_MS;
+        uint32_t exact = (uint32_t)((sum + GAME_CAST_SPREAD_MS / 2) / GAME_CAST_SPREAD_MS);
+        if(trawler_mean_wait_ms(base) != exact) {
+            fprintf(stderr, "base %ld: closed form %lu, brute force %lu\n", (long)base,
+                    (unsigned long)trawler_mean_wait_ms(base), (unsigned long)exact);
+            CHECK(false);
+            return;
+        }
+    }
+    CHECK_EQ(trawler_mean_wait_ms(1000 - LEVEL_MAX * 200 - 4 * 300), GAME_TICK_MS);
+}
+
+static void test_stepped(const TrawlerCase* c, uint32_t days) {
+    CyberFishApp* app = trawler_app(c, 0x2545F491u);
+    uint32_t span_s = days * 24 * 3600;
+    uint64_t span_ms = (uint64_t)span_s * 1000;
+    uint32_t now = game_splash_ms(app);
+    game_step(app, NULL, now);
+    uint32_t keep_rng = rng_seed_state(0x9E3779B9u);
+    uint64_t cycles = 0, kept = 0, elapsed = 0;
+    uint64_t tiers[RARITY_TIERS] = {0};
+    while(elapsed < span_ms) {
+        uint32_t cast = now;
+        GameInput input = {.key = GameKeyOk, .type = GameInputShort, .time = cast};
+        game_step(app, &input, cast);
+        CHECK_EQ(app->ui.current_state, StateFishing);
+        uint32_t bite = app->ui.deadline;
+        game_step(app, NULL, bite);
+        CHECK_EQ(app->ui.current_state, StateBite);
+        /* Reel in at once, then dismiss and recast within the handling time */
+        input.time = bite + 100;
+        game_step(app, &input, input.time);
+        CHECK_EQ(app->ui.current_state, StateCaught);
+        input.time = bite + 200;
+        game_step(app, &input, input.time);
+        now = bite + TRAWLER_HANDLE_MS;
+        elapsed += now - cast;
+        cycles++;
+        if(rng_range(&keep_rng, 100) < TRAWLER_YIELD_PCT) {
+            kept++;
+            tiers[app->ui.bite_tier]++;
+        }
+    }
+
+    double cycle = (double)elapsed / cycles;
+    double cycle_expected = trawler_mean_wait_ms(game_cast_base_ms(app)) + TRAWLER_HANDLE_MS;
+    double cycle_sd = GAME_CAST_SPREAD_MS / sqrt(12.0 * cycles);
+    CHECK(fabs(cycle - cycle_expected) <= 5 * cycle_sd + 0.5);
+
+    /* The bot ran a little past the span; scale back to it */
+    double kept_span = (double)kept * span_ms / elapsed;
+    uint64_t expected = trawler_expected_catches(app, span_s);
+    CHECK(fabs(kept_span - expected) <= 5 * sqrt((double)expected) + 1);
+    double worst = 0;
+    for(int t=0; t<RARITY_TIERS; t++) {
+        double mean = (double)expected * app->rarity.weight[t] / RARITY_ROLLS;
+        double got = (double)tiers[t] * span_ms / elapsed;
+        double sigma = fabs(got - mean) / sqrt(mean > 1 ? mean : 1);
+        if(sigma > worst) worst = sigma;
+        CHECK(sigma <= 5 + 1 / sqrt(mean > 1 ? mean : 1));
+    }
+
+    /* The closed form over the same span, within its three-sd noise */
+    CyberFishApp* offline = trawler_app(c, 0x6C8E9CF5u);
+    uint32_t added = trawler_run(offline, span_s);
+    double bound = 0;
+    for(int t=0; t<RARITY_TIERS; t++) {
+        if(offline->rarity.weight[t] == 0) continue;
+        uint16_t first, count;
+        content_tier_range(t, &first, &count);
+        double mean = (double)expected * offline->rarity.weight[t] / RARITY_ROLLS / count;
+        bound += count * (3 * sqrt(mean) + 1);
+    }
+    CHECK(fabs((double)added - expected) <= bound);
+
+    printf(
+        "lure=%u antenna=%u world=%u days=%lu cycle_ms=%.1f expected=%.1f kept=%.0f closed=%llu run=%lu tier_worst=%.2f sd\n",
+        c->lure, c->antenna, c->world, (unsigned long)days, cycle, cycle_expected, kept_span,
+        (unsigned long long)expected, (unsigned long)added, worst);
+    free(offline);
+    free(app);
+}
+
+int main(int argc, char** argv) {
+    uint32_t days = 3;
+    int opt;
+    while((opt = getopt(argc, argv, "d:")) != -1) {
+        if(opt != 'd') {
+            fprintf(stderr, "usage: %s [-d days]\n", argv[0]);
+            return 2;
+        }
+        days = strtoul(optarg, NULL, 0);
+    }
+    if(days == 0) days = 1;
+
+    content_load(NULL);
+    game_events_init();
+    test_mean_wait();
+    const TrawlerCase cases[] = {{0, 0, 0}, {2, 10, 2}, {6, 30, 4}};
+    for(size_t i=0; i<sizeof(cases) / sizeof(cases[0]); i++) test_stepped(&cases[i], days);
+    return host_test_done("trawler_test");
+}